@@ -0,0 +1,89 @@
+// Per-sprite cost of the sprite blit: the old Img::draw_on float path and the
+// game loop's per-pixel threshold copy versus the fused blend kernel.
+//   blend_bench [iterations]
+#include "Blend.hpp"
+#include <opencv2/opencv.hpp>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <vector>
+
+static const int CELL_PX = 96;
+
+// Img::draw_on before the fused kernel (BGRA sprite over BGRA board)
+static void legacy_draw_on(const cv::Mat& src, cv::Mat& roi) {
+    std::vector<cv::Mat> bgra;
+    cv::split(src, bgra);
+    cv::Mat mask;
+    bgra[3].convertTo(mask, CV_32F, 1.0 / 255.0);
+    for (int c = 0; c < 3; ++c) {
+        cv::Mat roi_channel, src_channel;
+        std::vector<cv::Mat> roi_channels;
+        cv::split(roi, roi_channels);
+        roi_channels[c].convertTo(roi_channel, CV_32F);
+        bgra[c].convertTo(src_channel, CV_32F);
+        roi_channel = (1.0 - mask).mul(roi_channel) + mask.mul(src_channel);
+        roi_channel.convertTo(roi_channels[c], roi.type());
+        cv::merge(roi_channels, roi);
+    }
+}
+
+// Game loop blit before the fused kernel (BGRA sprite over BGR frame)
+static void legacy_threshold_copy(const cv::Mat& src, cv::Mat& roi) {
+    std::vector<cv::Mat> channels;
+    cv::split(src, channels);
+    cv::Mat alpha = channels[3];
+    cv::Mat bgr;
+    cv::merge(std::vector<cv::Mat>{channels[0], channels[1], channels[2]}, bgr);
+    for (int i = 0; i < bgr.rows; ++i)
+        for (int j = 0; j < bgr.cols; ++j)
+            if (alpha.at<uchar>(i, j) > 128) roi.at<cv::Vec3b>(i, j) = bgr.at<cv::Vec3b>(i, j);
+}
+
+static double ns_per_call(int iterations, const std::function<void()>& fn) {
+    fn(); // warm-up
+    auto t0 = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i) fn();
+    auto t1 = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(t1 - t0).count() / iterations;
+}
+
+int main(int argc, char* argv[]) {
+    int iterations = argc > 1 ? std::atoi(argv[1]) : 2000;
+
+    // A sprite shaped like the real ones: transparent border, opaque body, soft edge
+    cv::Mat sprite(CELL_PX, CELL_PX, CV_8UC4);
+    cv::randu(sprite, cv::Scalar::all(0), cv::Scalar::all(256));
+    for (int y = 0; y < CELL_PX; ++y) {
+        for (int x = 0; x < CELL_PX; ++x) {
+            double r = std::hypot(x - CELL_PX / 2.0, y - CELL_PX / 2.0);
+            double a = std::clamp((CELL_PX * 0.4 - r) * 32.0, 0.0, 255.0);
+            sprite.at<cv::Vec4b>(y, x)[3] = static_cast<uchar>(a);
+        }
+    }
+    cv::Mat board_bgra(CELL_PX * 8, CELL_PX * 8, CV_8UC4, cv::Scalar(181, 136, 99, 255));
+    cv::Mat frame_bgr(CELL_PX * 8, CELL_PX * 8, CV_8UC3, cv::Scalar(181, 136, 99));
+    cv::Mat roi4 = board_bgra(cv::Rect(CELL_PX, CELL_PX, CELL_PX, CELL_PX));
+    cv::Mat roi3 = frame_bgr(cv::Rect(CELL_PX, CELL_PX, CELL_PX, CELL_PX));
+
+    std::printf("%dx%d sprite, %d iterations, best isa: %s\n", CELL_PX, CELL_PX, iterations,
+                blend_isa_name(blend_best_isa()));
+    std::printf("%-34s %10.0f ns/sprite\n", "before: Img::draw_on (float)",
+                ns_per_call(iterations, [&] { legacy_draw_on(sprite, roi4); }));
+    std::printf("%-34s %10.0f ns/sprite\n", "before: loop threshold copy",
+                ns_per_call(iterations, [&] { legacy_threshold_copy(sprite, roi3); }));
+    for (BlendIsa isa : {BlendIsa::Scalar, BlendIsa::SSE2, BlendIsa::AVX2}) {
+        if (static_cast<int>(isa) > static_cast<int>(blend_best_isa())) continue;
+        char label[64];
+        std::snprintf(label, sizeof(label), "after: kernel %s over BGRA", blend_isa_name(isa));
+        std::printf("%-34s %10.0f ns/sprite\n", label, ns_per_call(iterations, [&] {
+            blend_bgra_over(sprite.data, sprite.step, roi4.data, roi4.step, 4, CELL_PX, CELL_PX, isa);
+        }));
+        std::snprintf(label, sizeof(label), "after: kernel %s over BGR", blend_isa_name(isa));
+        std::printf("%-34s %10.0f ns/sprite\n", label, ns_per_call(iterations, [&] {
+            blend_bgra_over(sprite.data, sprite.step, roi3.data, roi3.step, 3, CELL_PX, CELL_PX, isa);
+        }));
+    }
+    return 0;
+}
@@ -0,0 +1,104 @@
+// Per-frame cost of advancing N travelling pieces: one heap object per piece
+// with a virtual update (the MovePhysics layout) versus MoveBatch's arrays,
+// scalar and SSE2.
+//   move_bench [pieces] [frames]
+#include "MoveBatch.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <memory>
+#include <random>
+#include <vector>
+
+// MovePhysics::update's arithmetic and data layout, without Board/Sound
+struct LegacyMover {
+    virtual ~LegacyMover() = default;
+    std::vector<int> start_cell{0, 0}, end_cell{0, 0};
+    std::vector<float> pos{0.0f, 0.0f}, dir{0.0f, 0.0f};
+    float speed = 1.0f, length = 0.0f, duration_s = 0.0f;
+    int start_ms = 0;
+    virtual bool update(int now_ms) {
+        float t = (now_ms - start_ms) / 1000.0f;
+        float d = std::min(t * speed, length);
+        pos[0] = start_cell[0] + dir[0] * d;
+        pos[1] = start_cell[1] + dir[1] * d;
+        return t >= duration_s;
+    }
+};
+
+struct Move {
+    int sr, sc, dr, dc;
+    float speed;
+    int start_ms;
+};
+
+static double ms_per_frame(int frames, const std::function<void(int)>& frame) {
+    auto t0 = std::chrono::steady_clock::now();
+    for (int f = 0; f < frames; ++f) frame(f);
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count() / frames;
+}
+
+int main(int argc, char* argv[]) {
+    size_t count = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 4096;
+    int frames = argc > 2 ? std::atoi(argv[2]) : 600;
+    count = std::min<size_t>(count, NO_PIECE);
+    std::mt19937 rng(7);
+    std::vector<Move> moves;
+    while (moves.size() < count) {
+        Move m{int(rng() % 64), int(rng() % 64), int(rng() % 64), int(rng() % 64), 1.0f + (rng() % 30) / 10.0f, int(rng() % 1000)};
+        if (m.sr != m.dr || m.sc != m.dc) moves.push_back(m);
+    }
+    // Long trips so most pieces stay in flight for the whole run
+    for (auto& m : moves) m.speed *= 0.002f;
+
+    std::vector<std::unique_ptr<LegacyMover>> legacy;
+    for (const auto& m : moves) {
+        auto p = std::make_unique<LegacyMover>();
+        p->start_cell = {m.sr, m.sc};
+        p->end_cell = {m.dr, m.dc};
+        p->length = std::hypot(float(m.dr - m.sr), float(m.dc - m.sc));
+        p->dir = {(m.dr - m.sr) / p->length, (m.dc - m.sc) / p->length};
+        p->speed = m.speed;
+        p->duration_s = p->length / m.speed;
+        p->start_ms = m.start_ms;
+        legacy.push_back(std::move(p));
+    }
+    auto make_batch = [&] {
+        MoveBatch b;
+        for (size_t i = 0; i < moves.size(); ++i)
+            b.add(static_cast<PieceHandle>(i), {moves[i].sr, moves[i].sc}, {moves[i].dr, moves[i].dc}, moves[i].speed, moves[i].start_ms);
+        return b;
+    };
+    std::vector<float> row(count), col(count), row_simd(count), col_simd(count);
+
+    // Same positions either way
+    {
+        MoveBatch a = make_batch(), b = make_batch();
+        size_t mismatches = 0;
+        for (int now = 1000; now < 60000; now += 997) {
+            a.integrate(now, row.data(), col.data(), false);
+            b.integrate(now, row_simd.data(), col_simd.data(), true);
+            for (size_t i = 0; i < count; ++i)
+                if (std::fabs(row[i] - row_simd[i]) > 1e-4f || std::fabs(col[i] - col_simd[i]) > 1e-4f) ++mismatches;
+        }
+        std::printf("%zu pieces, %d frames, %zu scalar/SSE2 mismatches\n", count, frames, mismatches);
+    }
+
+    volatile size_t sink = 0;
+    std::printf("  %-34s %8.4f ms/frame\n", "before: virtual update per piece", ms_per_frame(frames, [&](int f) {
+        size_t done = 0;
+        for (auto& p : legacy) done += p->update(1000 + f * 16);
+        sink = sink + done;
+    }));
+    MoveBatch scalar = make_batch(), simd = make_batch();
+    std::printf("  %-34s %8.4f ms/frame\n", "after: MoveBatch scalar", ms_per_frame(frames, [&](int f) {
+        scalar.integrate(1000 + f * 16, row.data(), col.data(), false);
+    }));
+    std::printf("  %-34s %8.4f ms/frame\n", "after: MoveBatch SSE2", ms_per_frame(frames, [&](int f) {
+        simd.integrate(1000 + f * 16, row_simd.data(), col_simd.data(), true);
+    }));
+    return 0;
+}
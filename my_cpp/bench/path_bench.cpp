@@ -0,0 +1,95 @@
+// Cost of the sliding-piece path check: the original float-stepping walk over
+// the std::map board index versus the ray tables against an occupancy mask.
+//   path_bench [iterations]
+#include <cmath>
+#include "Moves.hpp"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <random>
+#include <vector>
+
+using CellMap = std::map<std::pair<int, int>, std::vector<std::shared_ptr<Piece>>>;
+using Cell = std::pair<int, int>;
+
+// Moves::_path_is_clear before the ray tables (minus its blocked-path print)
+static bool legacy_path_is_clear(const Cell& src_cell, const Cell& dst_cell, const CellMap& cell2piece) {
+    int dr = dst_cell.first - src_cell.first;
+    int dc = dst_cell.second - src_cell.second;
+    int steps = std::max(std::abs(dr), std::abs(dc));
+    if (steps == 0) return true;
+    float step_r = dr / static_cast<float>(steps);
+    float step_c = dc / static_cast<float>(steps);
+    for (int i = 1; i < steps; ++i) {
+        int r = src_cell.first + static_cast<int>(i * step_r);
+        int c = src_cell.second + static_cast<int>(i * step_c);
+        if (cell2piece.find(std::make_pair(r, c)) != cell2piece.end()) return false;
+    }
+    return true;
+}
+
+struct Query {
+    Cell src, dst;
+};
+
+// Straight and diagonal rook/bishop/queen moves of every length
+static std::vector<Query> make_queries(size_t count, std::mt19937& rng) {
+    static const int DR[8] = {-1, 1, 0, 0, -1, -1, 1, 1};
+    static const int DC[8] = {0, 0, -1, 1, -1, 1, -1, 1};
+    std::vector<Query> queries;
+    while (queries.size() < count) {
+        Cell src{static_cast<int>(rng() % 8), static_cast<int>(rng() % 8)};
+        int d = rng() % 8, len = 1 + rng() % 7;
+        Cell dst{src.first + DR[d] * len, src.second + DC[d] * len};
+        if (on_board(dst.first, dst.second)) queries.push_back({src, dst});
+    }
+    return queries;
+}
+
+static double ns_per_call(int iterations, size_t calls, const std::function<size_t()>& fn) {
+    volatile size_t sink = fn(); // warm-up
+    auto t0 = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i) sink = sink + fn();
+    auto t1 = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(t1 - t0).count() / (static_cast<double>(iterations) * calls);
+}
+
+static void run_board(const char* name, const std::vector<Cell>& cells, const std::vector<Query>& queries, int iterations) {
+    CellMap cell2piece;
+    Occupancy occ;
+    for (const auto& c : cells) {
+        cell2piece[c].push_back(nullptr);
+        occ.place(square_of(c), 0, PieceColor::White, PieceType::Pawn);
+    }
+    size_t mismatches = 0;
+    for (const auto& q : queries) {
+        if (legacy_path_is_clear(q.src, q.dst, cell2piece) != ((Moves::path_mask(q.src, q.dst) & occ.all) == 0)) ++mismatches;
+    }
+    std::printf("%s board (%zu pieces), %zu queries, %zu mismatches\n", name, cells.size(), queries.size(), mismatches);
+    std::printf("  %-32s %8.1f ns/check\n", "before: float walk + map::find", ns_per_call(iterations, queries.size(), [&] {
+        size_t clear = 0;
+        for (const auto& q : queries) clear += legacy_path_is_clear(q.src, q.dst, cell2piece);
+        return clear;
+    }));
+    std::printf("  %-32s %8.1f ns/check\n", "after: ray tables & occupancy", ns_per_call(iterations, queries.size(), [&] {
+        size_t clear = 0;
+        for (const auto& q : queries) clear += (Moves::path_mask(q.src, q.dst) & occ.all) == 0;
+        return clear;
+    }));
+}
+
+int main(int argc, char* argv[]) {
+    int iterations = argc > 1 ? std::atoi(argv[1]) : 200;
+    std::mt19937 rng(12345);
+    auto queries = make_queries(4096, rng);
+
+    std::vector<Cell> dense; // starting position
+    for (int r : {0, 1, 6, 7})
+        for (int c = 0; c < 8; ++c) dense.push_back({r, c});
+    std::vector<Cell> sparse{{0, 4}, {7, 4}, {3, 3}, {5, 6}, {2, 1}, {6, 0}}; // endgame
+
+    run_board("dense", dense, queries, iterations);
+    run_board("sparse", sparse, queries, iterations);
+    return 0;
+}
@@ -0,0 +1,519 @@
+#pragma once
+#include "Img.hpp"
+#include "Moves.hpp"
+#include "PieceTemplate.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+#include <nlohmann/json.hpp>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// Single-file asset pack built by tools/pack_assets from pieces/, pic/ and
+// sounds/. Everything create_game needs is stored ready to use: pre-scaled
+// BGRA sprite frames, compiled move tables, transition tables and parsed
+// physics/graphics configs. The file is mapped read-only and pixel data is
+// used in place, so processes running from the same pack share its pages.
+//
+// Layout: PackHeader, then arrays of the fixed-size records below (each
+// section 64-byte aligned, located by a PackSection), then pixel and blob
+// payloads. All offsets are from the start of the file.
+//
+// Freshness is the build's job: the asset_pack target depends on every file
+// under pieces/, pic/ and sounds/ and rebuilds the pack when one changes.
+
+constexpr char PACK_MAGIC[8] = {'C', 'H', 'E', 'S', 'S', 'P', 'K', '\0'};
+constexpr uint32_t PACK_VERSION = 1;
+constexpr uint64_t PACK_ALIGN = 64;
+constexpr int PACK_LAYOUT_CODE = 4; // piece code + NUL, e.g. "PW"
+
+struct PackString {
+    uint32_t offset; // into the string section
+    uint32_t length;
+};
+
+struct PackSection {
+    uint64_t offset;
+    uint64_t count;
+};
+
+struct PackImage {
+    PackString name;
+    uint32_t width, height, channels, step;
+    uint64_t data_offset;
+};
+
+struct PackBlob {
+    PackString name;
+    uint64_t offset, size;
+};
+
+struct PackMove {
+    int32_t dr, dc;
+    PackString tag;
+};
+
+struct PackMoveTables {
+    Bitboard capture[SQUARE_COUNT];
+    Bitboard quiet[SQUARE_COUNT];
+    Bitboard either[SQUARE_COUNT];
+};
+
+struct PackState {
+    PackString name;
+    uint32_t first_frame, frame_count; // into the image section
+    int32_t move_tables;               // -1 = state has no moves.txt
+    uint32_t first_move, move_count;
+    int32_t dims_rows, dims_cols;
+    float speed_m_per_sec, duration_ms, fps;
+    uint8_t has_speed, has_duration, need_clear_path, loop;
+};
+
+struct PackType {
+    PackString name;
+    uint32_t first_state, state_count;
+    uint32_t first_transition, transition_count;
+};
+
+struct PackTransition {
+    PackString from, event, to;
+};
+
+struct PackHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t cell_px;
+    uint64_t file_size;
+    PackSection strings, images, blobs, moves, move_tables, states, types, transitions;
+    int32_t board_image; // index into images, -1 = none
+    uint32_t layout_rows, layout_cols;
+    char layout[SQUARE_COUNT][PACK_LAYOUT_CODE];
+};
+
+inline uint64_t pack_align(uint64_t n) { return (n + PACK_ALIGN - 1) & ~(PACK_ALIGN - 1); }
+
+// Collects assets in memory and writes them out as a pack.
+class AssetPackWriter {
+public:
+    void set_cell_px(int cell_px) { _header.cell_px = static_cast<uint32_t>(cell_px); }
+
+    void set_layout(const std::vector<std::vector<std::string>>& rows) {
+        _header.layout_rows = static_cast<uint32_t>(std::min<size_t>(rows.size(), BOARD_DIM));
+        _header.layout_cols = 0;
+        for (size_t r = 0; r < _header.layout_rows; ++r) {
+            for (size_t c = 0; c < rows[r].size() && c < BOARD_DIM; ++c) {
+                std::strncpy(_header.layout[square_of(int(r), int(c))], rows[r][c].c_str(), PACK_LAYOUT_CODE - 1);
+                _header.layout_cols = std::max<uint32_t>(_header.layout_cols, static_cast<uint32_t>(c + 1));
+            }
+        }
+    }
+
+    uint32_t add_image(const std::string& name, const cv::Mat& img) {
+        if (img.empty() || img.depth() != CV_8U) throw std::runtime_error("Cannot pack image: " + name);
+        PackImage rec{};
+        rec.name = _string(name);
+        rec.width = img.cols;
+        rec.height = img.rows;
+        rec.channels = img.channels();
+        rec.step = static_cast<uint32_t>(img.cols * img.elemSize());
+        _images.push_back(rec);
+        _pixels.push_back(img.isContinuous() ? img : img.clone());
+        return static_cast<uint32_t>(_images.size() - 1);
+    }
+
+    void set_board_image(const cv::Mat& img) { _header.board_image = static_cast<int32_t>(add_image("board", img)); }
+
+    void add_blob(const std::string& name, std::string bytes) {
+        PackBlob rec{};
+        rec.name = _string(name);
+        rec.size = bytes.size();
+        _blobs.push_back(rec);
+        _blob_data.push_back(std::move(bytes));
+    }
+
+    // Sprite frames are stored as BGRA so the blend kernel can use them directly.
+    void add_template(const PieceTemplate& tpl) {
+        PackType type{};
+        type.name = _string(tpl.type);
+        type.first_state = static_cast<uint32_t>(_states.size());
+        for (const auto& [name, st] : tpl.states) {
+            PackState rec{};
+            rec.name = _string(name);
+            rec.first_frame = static_cast<uint32_t>(_images.size());
+            if (st.frames) {
+                for (size_t i = 0; i < st.frames->size(); ++i) {
+                    cv::Mat frame = (*st.frames)[i].img;
+                    if (frame.channels() == 3) cv::cvtColor(frame, frame, cv::COLOR_BGR2BGRA);
+                    add_image(tpl.type + "/" + name + "/" + std::to_string(i), frame);
+                }
+            }
+            rec.frame_count = static_cast<uint32_t>(_images.size()) - rec.first_frame;
+            rec.move_tables = -1;
+            if (st.moves) {
+                rec.dims_rows = st.moves->dims.first;
+                rec.dims_cols = st.moves->dims.second;
+                rec.first_move = static_cast<uint32_t>(_moves.size());
+                for (const auto& [offset, tag] : st.moves->moves) _moves.push_back({offset.first, offset.second, _string(tag)});
+                rec.move_count = static_cast<uint32_t>(_moves.size()) - rec.first_move;
+                if (st.moves->has_tables()) {
+                    PackMoveTables t{};
+                    for (int sq = 0; sq < SQUARE_COUNT; ++sq) {
+                        t.capture[sq] = st.moves->capture_mask[sq];
+                        t.quiet[sq] = st.moves->quiet_mask[sq];
+                        t.either[sq] = st.moves->either_mask[sq];
+                    }
+                    rec.move_tables = static_cast<int32_t>(_tables.size());
+                    _tables.push_back(t);
+                }
+            }
+            rec.has_speed = st.physics_cfg.contains("speed_m_per_sec");
+            rec.speed_m_per_sec = rec.has_speed ? st.physics_cfg["speed_m_per_sec"].get<float>() : 0.0f;
+            rec.has_duration = st.physics_cfg.contains("duration_ms");
+            rec.duration_ms = rec.has_duration ? st.physics_cfg["duration_ms"].get<float>() : 0.0f;
+            rec.need_clear_path = st.need_clear_path;
+            rec.loop = st.loop;
+            rec.fps = st.fps;
+            _states.push_back(rec);
+        }
+        type.state_count = static_cast<uint32_t>(_states.size()) - type.first_state;
+        type.first_transition = static_cast<uint32_t>(_transitions.size());
+        for (const auto& [from, events] : tpl.transitions)
+            for (const auto& [event, to] : events) _transitions.push_back({_string(from), _string(event), _string(to)});
+        type.transition_count = static_cast<uint32_t>(_transitions.size()) - type.first_transition;
+        _types.push_back(type);
+    }
+
+    void write(const std::filesystem::path& path) {
+        PackHeader h = _header;
+        std::memcpy(h.magic, PACK_MAGIC, sizeof(h.magic));
+        h.version = PACK_VERSION;
+        uint64_t pos = pack_align(sizeof(PackHeader));
+        auto place = [&](PackSection& s, uint64_t count, uint64_t bytes) {
+            s = {pos, count};
+            pos = pack_align(pos + bytes);
+        };
+        place(h.strings, _strings.size(), _strings.size());
+        place(h.images, _images.size(), _images.size() * sizeof(PackImage));
+        place(h.blobs, _blobs.size(), _blobs.size() * sizeof(PackBlob));
+        place(h.moves, _moves.size(), _moves.size() * sizeof(PackMove));
+        place(h.move_tables, _tables.size(), _tables.size() * sizeof(PackMoveTables));
+        place(h.states, _states.size(), _states.size() * sizeof(PackState));
+        place(h.types, _types.size(), _types.size() * sizeof(PackType));
+        place(h.transitions, _transitions.size(), _transitions.size() * sizeof(PackTransition));
+        for (auto& img : _images) {
+            img.data_offset = pos;
+            pos = pack_align(pos + uint64_t(img.step) * img.height);
+        }
+        for (auto& blob : _blobs) {
+            blob.offset = pos;
+            pos = pack_align(pos + blob.size);
+        }
+        h.file_size = pos;
+
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        if (!out) throw std::runtime_error("Cannot write asset pack: " + path.string());
+        uint64_t written = 0;
+        auto put = [&](uint64_t at, const void* data, uint64_t size) {
+            static const char zeros[PACK_ALIGN] = {};
+            while (written < at) {
+                uint64_t n = std::min<uint64_t>(at - written, PACK_ALIGN);
+                out.write(zeros, static_cast<std::streamsize>(n));
+                written += n;
+            }
+            out.write(static_cast<const char*>(data), static_cast<std::streamsize>(size));
+            written += size;
+        };
+        put(0, &h, sizeof(h));
+        put(h.strings.offset, _strings.data(), _strings.size());
+        put(h.images.offset, _images.data(), _images.size() * sizeof(PackImage));
+        put(h.blobs.offset, _blobs.data(), _blobs.size() * sizeof(PackBlob));
+        put(h.moves.offset, _moves.data(), _moves.size() * sizeof(PackMove));
+        put(h.move_tables.offset, _tables.data(), _tables.size() * sizeof(PackMoveTables));
+        put(h.states.offset, _states.data(), _states.size() * sizeof(PackState));
+        put(h.types.offset, _types.data(), _types.size() * sizeof(PackType));
+        put(h.transitions.offset, _transitions.data(), _transitions.size() * sizeof(PackTransition));
+        for (size_t i = 0; i < _images.size(); ++i)
+            put(_images[i].data_offset, _pixels[i].data, uint64_t(_images[i].step) * _images[i].height);
+        for (size_t i = 0; i < _blobs.size(); ++i) put(_blobs[i].offset, _blob_data[i].data(), _blob_data[i].size());
+        put(h.file_size, nullptr, 0);
+        if (!out) throw std::runtime_error("Failed writing asset pack: " + path.string());
+    }
+
+private:
+    PackHeader _header = [] {
+        PackHeader h{};
+        h.board_image = -1;
+        return h;
+    }();
+    std::string _strings;
+    std::map<std::string, PackString> _string_index;
+    std::vector<PackImage> _images;
+    std::vector<cv::Mat> _pixels;
+    std::vector<PackBlob> _blobs;
+    std::vector<std::string> _blob_data;
+    std::vector<PackMove> _moves;
+    std::vector<PackMoveTables> _tables;
+    std::vector<PackState> _states;
+    std::vector<PackType> _types;
+    std::vector<PackTransition> _transitions;
+
+    PackString _string(const std::string& s) {
+        auto it = _string_index.find(s);
+        if (it != _string_index.end()) return it->second;
+        PackString ref{static_cast<uint32_t>(_strings.size()), static_cast<uint32_t>(s.size())};
+        _strings += s;
+        _string_index.emplace(s, ref);
+        return ref;
+    }
+};
+
+// Read-only view of a mapped pack. Images wrap the mapping; templates()
+// hands out frame handles that own their frames and keep the pack (and so
+// the mapping) alive.
+class AssetPack : public std::enable_shared_from_this<AssetPack> {
+public:
+    // Throws std::runtime_error when the file is missing or malformed.
+    static std::shared_ptr<AssetPack> open(const std::filesystem::path& path) {
+        std::shared_ptr<AssetPack> pack(new AssetPack());
+        pack->_map(path);
+        pack->_validate(path);
+        pack->_index();
+        return pack;
+    }
+
+    AssetPack(const AssetPack&) = delete;
+    AssetPack& operator=(const AssetPack&) = delete;
+
+    ~AssetPack() { _unmap(); }
+
+    int cell_px() const { return static_cast<int>(_header().cell_px); }
+    size_t size_bytes() const { return _size; }
+
+    // board.csv as rows of piece codes ("" for empty squares)
+    std::vector<std::vector<std::string>> layout() const {
+        const PackHeader& h = _header();
+        std::vector<std::vector<std::string>> rows(h.layout_rows, std::vector<std::string>(h.layout_cols));
+        for (uint32_t r = 0; r < h.layout_rows; ++r)
+            for (uint32_t c = 0; c < h.layout_cols; ++c) {
+                const char* code = h.layout[square_of(int(r), int(c))];
+                rows[r][c].assign(code, strnlen(code, PACK_LAYOUT_CODE));
+            }
+        return rows;
+    }
+
+    // Empty Img when absent. The pixels are the mapped file: read-only.
+    Img image(std::string_view name) const {
+        auto it = _image_index.find(name);
+        return it != _image_index.end() ? _image(it->second) : Img();
+    }
+
+    Img board_image() const {
+        int32_t i = _header().board_image;
+        return i >= 0 ? _image(static_cast<uint32_t>(i)) : Img();
+    }
+
+    std::pair<const void*, size_t> blob(std::string_view name) const {
+        auto it = _blob_index.find(name);
+        if (it == _blob_index.end()) return {nullptr, 0};
+        const PackBlob& b = _records<PackBlob>(_header().blobs)[it->second];
+        return {_data + b.offset, static_cast<size_t>(b.size)};
+    }
+
+    // One template per piece type, with Moves rebuilt from the compiled
+    // tables and frames pointing into the mapping.
+    std::vector<std::shared_ptr<PieceTemplate>> templates() const {
+        const PackHeader& h = _header();
+        auto self = shared_from_this();
+        const PackType* types = _records<PackType>(h.types);
+        const PackState* states = _records<PackState>(h.states);
+        const PackMove* moves = _records<PackMove>(h.moves);
+        const PackMoveTables* tables = _records<PackMoveTables>(h.move_tables);
+        const PackTransition* transitions = _records<PackTransition>(h.transitions);
+        std::vector<std::shared_ptr<PieceTemplate>> result;
+        for (uint64_t t = 0; t < h.types.count; ++t) {
+            auto tpl = std::make_shared<PieceTemplate>();
+            tpl->type = _str(types[t].name);
+            for (uint32_t s = types[t].first_state; s < types[t].first_state + types[t].state_count; ++s) {
+                const PackState& ps = states[s];
+                StateTemplate st;
+                st.name = _str(ps.name);
+                st.physics_cfg = nlohmann::json::object();
+                if (ps.has_speed) st.physics_cfg["speed_m_per_sec"] = ps.speed_m_per_sec;
+                if (ps.has_duration) st.physics_cfg["duration_ms"] = ps.duration_ms;
+                st.need_clear_path = ps.need_clear_path != 0;
+                st.loop = ps.loop != 0;
+                st.fps = ps.fps;
+                if (ps.move_count > 0 || ps.move_tables >= 0) {
+                    std::map<std::pair<int, int>, std::string> offsets;
+                    for (uint32_t m = ps.first_move; m < ps.first_move + ps.move_count; ++m)
+                        offsets[{moves[m].dr, moves[m].dc}] = _str(moves[m].tag);
+                    if (ps.move_tables >= 0) {
+                        const PackMoveTables& mt = tables[ps.move_tables];
+                        st.moves = std::make_shared<const Moves>(std::move(offsets), std::make_pair(ps.dims_rows, ps.dims_cols),
+                                                                 std::vector<Bitboard>(mt.capture, mt.capture + SQUARE_COUNT),
+                                                                 std::vector<Bitboard>(mt.quiet, mt.quiet + SQUARE_COUNT),
+                                                                 std::vector<Bitboard>(mt.either, mt.either + SQUARE_COUNT));
+                    } else {
+                        st.moves = std::make_shared<const Moves>(std::move(offsets), std::make_pair(ps.dims_rows, ps.dims_cols));
+                    }
+                }
+                auto frames = std::make_unique<std::vector<Img>>();
+                for (uint32_t f = ps.first_frame; f < ps.first_frame + ps.frame_count; ++f) frames->push_back(_image(f));
+                // the frames point into the mapping: the deleter keeps the pack alive with them
+                st.frames = std::shared_ptr<const std::vector<Img>>(frames.release(), [self](const std::vector<Img>* v) { delete v; });
+                tpl->states.emplace(st.name, std::move(st));
+            }
+            for (uint32_t i = types[t].first_transition; i < types[t].first_transition + types[t].transition_count; ++i)
+                tpl->transitions[_str(transitions[i].from)][_str(transitions[i].event)] = _str(transitions[i].to);
+            tpl->compile_transitions();
+            result.push_back(std::move(tpl));
+        }
+        return result;
+    }
+
+private:
+    const uint8_t* _data = nullptr;
+    size_t _size = 0;
+#ifdef _WIN32
+    HANDLE _file = INVALID_HANDLE_VALUE;
+    HANDLE _mapping = nullptr;
+#endif
+    std::map<std::string, uint32_t, std::less<>> _image_index, _blob_index;
+
+    AssetPack() = default;
+
+    const PackHeader& _header() const { return *reinterpret_cast<const PackHeader*>(_data); }
+
+    template <typename T>
+    const T* _records(const PackSection& s) const { return reinterpret_cast<const T*>(_data + s.offset); }
+
+    std::string _str(const PackString& s) const {
+        return std::string(reinterpret_cast<const char*>(_data + _header().strings.offset + s.offset), s.length);
+    }
+
+    Img _image(uint32_t i) const {
+        const PackImage& rec = _records<PackImage>(_header().images)[i];
+        Img out;
+        out.img = cv::Mat(static_cast<int>(rec.height), static_cast<int>(rec.width), CV_8UC(rec.channels),
+                          const_cast<uint8_t*>(_data + rec.data_offset), rec.step);
+        return out;
+    }
+
+    void _map(const std::filesystem::path& path) {
+#ifdef _WIN32
+        _file = CreateFileW(path.wstring().c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (_file == INVALID_HANDLE_VALUE) throw std::runtime_error("Cannot open asset pack: " + path.string());
+        LARGE_INTEGER size;
+        if (!GetFileSizeEx(_file, &size)) throw std::runtime_error("Cannot stat asset pack: " + path.string());
+        _size = static_cast<size_t>(size.QuadPart);
+        _mapping = CreateFileMappingW(_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (!_mapping) throw std::runtime_error("Cannot map asset pack: " + path.string());
+        _data = static_cast<const uint8_t*>(MapViewOfFile(_mapping, FILE_MAP_READ, 0, 0, 0));
+        if (!_data) throw std::runtime_error("Cannot map asset pack: " + path.string());
+#else
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) throw std::runtime_error("Cannot open asset pack: " + path.string());
+        struct stat st;
+        if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+            ::close(fd);
+            throw std::runtime_error("Cannot stat asset pack: " + path.string());
+        }
+        _size = static_cast<size_t>(st.st_size);
+        void* p = mmap(nullptr, _size, PROT_READ, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (p == MAP_FAILED) throw std::runtime_error("Cannot map asset pack: " + path.string());
+        _data = static_cast<const uint8_t*>(p);
+#endif
+    }
+
+    void _unmap() {
+#ifdef _WIN32
+        if (_data) UnmapViewOfFile(_data);
+        if (_mapping) CloseHandle(_mapping);
+        if (_file != INVALID_HANDLE_VALUE) CloseHandle(_file);
+#else
+        if (_data) munmap(const_cast<uint8_t*>(_data), _size);
+#endif
+        _data = nullptr;
+    }
+
+    void _validate(const std::filesystem::path& path) const {
+        auto bad = [&](const char* what) { return std::runtime_error("Invalid asset pack " + path.string() + ": " + what); };
+        if (_size < sizeof(PackHeader)) throw bad("truncated header");
+        const PackHeader& h = _header();
+        if (std::memcmp(h.magic, PACK_MAGIC, sizeof(PACK_MAGIC)) != 0) throw bad("bad magic");
+        if (h.version != PACK_VERSION) throw bad("unsupported version");
+        if (h.file_size != _size) throw bad("size mismatch");
+        auto in_file = [&](uint64_t off, uint64_t bytes) { return off <= _size && bytes <= _size - off; };
+        auto section_ok = [&](const PackSection& s, size_t record) {
+            return s.count <= _size && in_file(s.offset, s.count * record);
+        };
+        if (!section_ok(h.strings, 1) || !section_ok(h.images, sizeof(PackImage)) || !section_ok(h.blobs, sizeof(PackBlob)) ||
+            !section_ok(h.moves, sizeof(PackMove)) || !section_ok(h.move_tables, sizeof(PackMoveTables)) ||
+            !section_ok(h.states, sizeof(PackState)) || !section_ok(h.types, sizeof(PackType)) ||
+            !section_ok(h.transitions, sizeof(PackTransition)))
+            throw bad("section out of range");
+        auto str_ok = [&](const PackString& s) { return uint64_t(s.offset) + s.length <= h.strings.count; };
+        const PackImage* images = _records<PackImage>(h.images);
+        for (uint64_t i = 0; i < h.images.count; ++i) {
+            const PackImage& im = images[i];
+            if (!str_ok(im.name) || im.channels == 0 || im.channels > 4 || im.step < uint64_t(im.width) * im.channels ||
+                !in_file(im.data_offset, uint64_t(im.step) * im.height))
+                throw bad("image out of range");
+        }
+        if (h.board_image >= 0 && uint64_t(h.board_image) >= h.images.count) throw bad("board image out of range");
+        const PackBlob* blobs = _records<PackBlob>(h.blobs);
+        for (uint64_t i = 0; i < h.blobs.count; ++i)
+            if (!str_ok(blobs[i].name) || !in_file(blobs[i].offset, blobs[i].size)) throw bad("blob out of range");
+        const PackMove* moves = _records<PackMove>(h.moves);
+        for (uint64_t i = 0; i < h.moves.count; ++i)
+            if (!str_ok(moves[i].tag)) throw bad("move out of range");
+        const PackState* states = _records<PackState>(h.states);
+        for (uint64_t i = 0; i < h.states.count; ++i) {
+            const PackState& s = states[i];
+            if (!str_ok(s.name) || uint64_t(s.first_frame) + s.frame_count > h.images.count ||
+                uint64_t(s.first_move) + s.move_count > h.moves.count ||
+                (s.move_tables >= 0 && uint64_t(s.move_tables) >= h.move_tables.count))
+                throw bad("state out of range");
+        }
+        const PackType* types = _records<PackType>(h.types);
+        for (uint64_t i = 0; i < h.types.count; ++i) {
+            const PackType& t = types[i];
+            if (!str_ok(t.name) || uint64_t(t.first_state) + t.state_count > h.states.count ||
+                uint64_t(t.first_transition) + t.transition_count > h.transitions.count)
+                throw bad("type out of range");
+        }
+        const PackTransition* transitions = _records<PackTransition>(h.transitions);
+        for (uint64_t i = 0; i < h.transitions.count; ++i)
+            if (!str_ok(transitions[i].from) || !str_ok(transitions[i].event) || !str_ok(transitions[i].to))
+                throw bad("transition out of range");
+        if (h.layout_rows > BOARD_DIM || h.layout_cols > BOARD_DIM) throw bad("layout out of range");
+    }
+
+    void _index() {
+        const PackHeader& h = _header();
+        const PackImage* images = _records<PackImage>(h.images);
+        for (uint64_t i = 0; i < h.images.count; ++i) _image_index.emplace(_str(images[i].name), static_cast<uint32_t>(i));
+        const PackBlob* blobs = _records<PackBlob>(h.blobs);
+        for (uint64_t i = 0; i < h.blobs.count; ++i) _blob_index.emplace(_str(blobs[i].name), static_cast<uint32_t>(i));
+    }
+};
@@ -0,0 +1,195 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <string_view>
+#include <utility>
+
+// 8x8 board occupancy as 64-bit masks. Square index = row * 8 + col, so bit 0
+// is (0,0) - black's back rank - and bit 63 is (7,7).
+
+using Bitboard = uint64_t;
+
+enum class PieceColor : uint8_t { White = 0, Black, Count };
+enum class PieceType : uint8_t { King = 0, Queen, Rook, Bishop, Knight, Pawn, Count };
+
+constexpr int BOARD_DIM = 8;
+constexpr int SQUARE_COUNT = 64;
+
+constexpr bool on_board(int row, int col) { return row >= 0 && row < BOARD_DIM && col >= 0 && col < BOARD_DIM; }
+constexpr int square_of(int row, int col) { return row * BOARD_DIM + col; }
+constexpr int square_of(std::pair<int, int> cell) { return square_of(cell.first, cell.second); }
+constexpr std::pair<int, int> cell_of(int sq) { return {sq / BOARD_DIM, sq % BOARD_DIM}; }
+constexpr Bitboard square_bb(int sq) { return Bitboard(1) << sq; }
+
+inline int popcount(Bitboard b) {
+#if defined(_MSC_VER) && !defined(__clang__)
+    int n = 0;
+    for (; b; b &= b - 1) ++n;
+    return n;
+#else
+    return __builtin_popcountll(b);
+#endif
+}
+
+// Index of the lowest set bit; b must not be 0.
+inline int lsb(Bitboard b) {
+#if defined(_MSC_VER) && !defined(__clang__)
+    int i = 0;
+    while (!(b & 1)) { b >>= 1; ++i; }
+    return i;
+#else
+    return __builtin_ctzll(b);
+#endif
+}
+
+inline int pop_lsb(Bitboard& b) {
+    int sq = lsb(b);
+    b &= b - 1;
+    return sq;
+}
+
+// Color letter of a piece code ('W', 'B'); Count for anything else
+inline PieceColor color_from_char(char c) {
+    return c == 'W' ? PieceColor::White : c == 'B' ? PieceColor::Black : PieceColor::Count;
+}
+
+// Piece ids start with the piece code: type letter then color letter ("QW_7,4").
+inline bool parse_piece_code(std::string_view id, PieceType& type, PieceColor& color) {
+    if (id.size() < 2) return false;
+    switch (id[0]) {
+        case 'K': type = PieceType::King; break;
+        case 'Q': type = PieceType::Queen; break;
+        case 'R': type = PieceType::Rook; break;
+        case 'B': type = PieceType::Bishop; break;
+        case 'N': type = PieceType::Knight; break;
+        case 'P': type = PieceType::Pawn; break;
+        default: return false;
+    }
+    color = color_from_char(id[1]);
+    return color != PieceColor::Count;
+}
+
+// Inverse of parse_piece_code: the two-letter code, e.g. "QW"
+inline std::string piece_code(PieceType type, PieceColor color) {
+    static constexpr char TYPE_CHARS[] = "KQRBNP", COLOR_CHARS[] = "WB";
+    if (type == PieceType::Count || color == PieceColor::Count) return "";
+    return {TYPE_CHARS[static_cast<size_t>(type)], COLOR_CHARS[static_cast<size_t>(color)]};
+}
+
+// Rays for sliding pieces: ray(dir, sq) holds every square from sq (exclusive)
+// to the board edge in one of the 8 directions.
+enum RayDir { RAY_N = 0, RAY_S, RAY_W, RAY_E, RAY_NW, RAY_NE, RAY_SW, RAY_SE, RAY_DIR_COUNT };
+
+class RayTables {
+public:
+    Bitboard ray[RAY_DIR_COUNT][SQUARE_COUNT];
+
+    RayTables() {
+        static const int DR[RAY_DIR_COUNT] = {-1, 1, 0, 0, -1, -1, 1, 1};
+        static const int DC[RAY_DIR_COUNT] = {0, 0, -1, 1, -1, 1, -1, 1};
+        for (int d = 0; d < RAY_DIR_COUNT; ++d) {
+            for (int sq = 0; sq < SQUARE_COUNT; ++sq) {
+                Bitboard b = 0;
+                auto [r, c] = cell_of(sq);
+                for (r += DR[d], c += DC[d]; on_board(r, c); r += DR[d], c += DC[d]) b |= square_bb(square_of(r, c));
+                ray[d][sq] = b;
+            }
+        }
+    }
+
+    // Direction of a straight or diagonal step (dr, dc), or -1 when the two
+    // cells are not on one line.
+    static int direction(int dr, int dc) {
+        if (dr == 0 && dc == 0) return -1;
+        if (dr != 0 && dc != 0 && dr != dc && dr != -dc) return -1;
+        int sr = (dr > 0) - (dr < 0), sc = (dc > 0) - (dc < 0);
+        if (sc == 0) return sr < 0 ? RAY_N : RAY_S;
+        if (sr == 0) return sc < 0 ? RAY_W : RAY_E;
+        if (sr < 0) return sc < 0 ? RAY_NW : RAY_NE;
+        return sc < 0 ? RAY_SW : RAY_SE;
+    }
+
+    // Squares strictly between two on-board squares on one line (dir from direction()).
+    Bitboard between(int from, int to, int dir) const {
+        return ray[dir][from] & ~ray[dir][to] & ~square_bb(to);
+    }
+};
+
+inline const RayTables& ray_tables() {
+    static const RayTables tables;
+    return tables;
+}
+
+inline PieceColor opposite(PieceColor c) { return c == PieceColor::White ? PieceColor::Black : PieceColor::White; }
+
+// Small integer naming a piece in the owner's piece list.
+using PieceHandle = uint16_t;
+constexpr PieceHandle NO_PIECE = 0xFFFF;
+
+// Per-color and per-type occupancy plus square -> piece handle. Pieces can
+// briefly share a square while a collision is pending: the square keeps the
+// first handle placed there and is flagged in `stacked`.
+class Occupancy {
+public:
+    Bitboard all = 0;
+    Bitboard stacked = 0;
+    std::array<Bitboard, static_cast<size_t>(PieceColor::Count)> by_color{};
+    std::array<Bitboard, static_cast<size_t>(PieceType::Count)> by_type{};
+    std::array<PieceHandle, SQUARE_COUNT> square_piece;
+
+    Occupancy() { clear(); }
+
+    void clear() {
+        all = stacked = 0;
+        by_color.fill(0);
+        by_type.fill(0);
+        square_piece.fill(NO_PIECE);
+    }
+
+    void place(int sq, PieceHandle h, PieceColor color, PieceType type) {
+        Bitboard b = square_bb(sq);
+        if (all & b) {
+            stacked |= b;
+        } else {
+            square_piece[sq] = h;
+        }
+        all |= b;
+        by_color[static_cast<size_t>(color)] |= b;
+        by_type[static_cast<size_t>(type)] |= b;
+    }
+
+    // Clears the square entirely, whatever was stacked on it.
+    void remove(int sq) {
+        Bitboard keep = ~square_bb(sq);
+        all &= keep;
+        stacked &= keep;
+        for (auto& m : by_color) m &= keep;
+        for (auto& m : by_type) m &= keep;
+        square_piece[sq] = NO_PIECE;
+    }
+
+    bool occupied(int sq) const { return (all & square_bb(sq)) != 0; }
+    bool occupied(std::pair<int, int> cell) const { return on_board(cell.first, cell.second) && occupied(square_of(cell)); }
+
+    Bitboard color(PieceColor c) const { return by_color[static_cast<size_t>(c)]; }
+    Bitboard type(PieceType t) const { return by_type[static_cast<size_t>(t)]; }
+    Bitboard pieces(PieceColor c, PieceType t) const { return color(c) & type(t); }
+
+    bool is_friendly(int sq, PieceColor c) const { return (color(c) & square_bb(sq)) != 0; }
+    bool is_enemy(int sq, PieceColor c) const { return (color(opposite(c)) & square_bb(sq)) != 0; }
+
+    PieceHandle piece_at(int sq) const { return square_piece[sq]; }
+
+    // Adapter for code still holding the std::map cell -> pieces view: only
+    // occupancy is known there, not colors or types.
+    template <typename PieceList>
+    static Occupancy from_cell_map(const std::map<std::pair<int, int>, PieceList>& cell2piece) {
+        Occupancy occ;
+        for (const auto& [cell, plist] : cell2piece) {
+            if (!plist.empty() && on_board(cell.first, cell.second)) occ.all |= square_bb(square_of(cell));
+        }
+        return occ;
+    }
+};
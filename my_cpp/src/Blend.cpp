@@ -0,0 +1,226 @@
+#include "Blend.hpp"
+
+// SSE2 is part of the x86-64 baseline; 32-bit builds only get it when enabled
+#if defined(__x86_64__) || defined(_M_X64) || defined(__SSE2__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define KFC_BLEND_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#define KFC_TARGET_AVX2
+#else
+#define KFC_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+
+namespace {
+
+inline uint8_t div255(unsigned t) {
+    return static_cast<uint8_t>((t + (t >> 8)) >> 8);
+}
+
+inline void blend_px(const uint8_t* s, uint8_t* d) {
+    unsigned a = s[3];
+    if (a == 0) return;
+    if (a == 255) {
+        d[0] = s[0]; d[1] = s[1]; d[2] = s[2];
+        return;
+    }
+    unsigned na = 255 - a;
+    d[0] = div255(s[0] * a + d[0] * na + 128);
+    d[1] = div255(s[1] * a + d[1] * na + 128);
+    d[2] = div255(s[2] * a + d[2] * na + 128);
+}
+
+void blend_row_scalar(const uint8_t* s, uint8_t* d, int dst_cn, int width) {
+    for (int x = 0; x < width; ++x, s += 4, d += dst_cn) blend_px(s, d);
+}
+
+#ifdef KFC_BLEND_X86
+
+inline uint32_t load_bgr(const uint8_t* p) {
+    return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) | (static_cast<uint32_t>(p[2]) << 16);
+}
+
+inline void store_bgr(uint8_t* p, uint32_t v) {
+    p[0] = static_cast<uint8_t>(v);
+    p[1] = static_cast<uint8_t>(v >> 8);
+    p[2] = static_cast<uint8_t>(v >> 16);
+}
+
+// Alpha bytes of four BGRA pixels live at byte positions 3, 7, 11, 15.
+constexpr int ALPHA_BITS_4PX = 0x8888;
+
+// s, d: 8 x u16 lanes (two pixels); returns the rounded blend in u16 lanes.
+inline __m128i blend_u16_sse2(__m128i s, __m128i d) {
+    const __m128i c255 = _mm_set1_epi16(255);
+    const __m128i c128 = _mm_set1_epi16(128);
+    __m128i a = _mm_shufflehi_epi16(_mm_shufflelo_epi16(s, 0xFF), 0xFF);
+    __m128i t = _mm_add_epi16(_mm_add_epi16(_mm_mullo_epi16(s, a),
+                                            _mm_mullo_epi16(d, _mm_sub_epi16(c255, a))), c128);
+    return _mm_srli_epi16(_mm_add_epi16(t, _mm_srli_epi16(t, 8)), 8);
+}
+
+void blend_row_sse2(const uint8_t* s, uint8_t* d, int dst_cn, int width) {
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i ones = _mm_set1_epi8(static_cast<char>(0xFF));
+    const __m128i alpha_lane = _mm_set1_epi32(static_cast<int>(0xFF000000u));
+    int x = 0;
+    for (; x + 4 <= width; x += 4, s += 16, d += 4 * dst_cn) {
+        __m128i src = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s));
+        if ((_mm_movemask_epi8(_mm_cmpeq_epi8(src, zero)) & ALPHA_BITS_4PX) == ALPHA_BITS_4PX) continue;
+        bool opaque = (_mm_movemask_epi8(_mm_cmpeq_epi8(src, ones)) & ALPHA_BITS_4PX) == ALPHA_BITS_4PX;
+        if (opaque && dst_cn == 3) {
+            for (int i = 0; i < 4; ++i) {
+                d[3 * i] = s[4 * i]; d[3 * i + 1] = s[4 * i + 1]; d[3 * i + 2] = s[4 * i + 2];
+            }
+            continue;
+        }
+
+        __m128i dst;
+        if (dst_cn == 4) {
+            dst = _mm_loadu_si128(reinterpret_cast<const __m128i*>(d));
+        } else {
+            dst = _mm_setr_epi32(static_cast<int>(load_bgr(d)), static_cast<int>(load_bgr(d + 3)),
+                                 static_cast<int>(load_bgr(d + 6)), static_cast<int>(load_bgr(d + 9)));
+        }
+        __m128i out;
+        if (opaque) {
+            out = src;
+        } else {
+            __m128i lo = blend_u16_sse2(_mm_unpacklo_epi8(src, zero), _mm_unpacklo_epi8(dst, zero));
+            __m128i hi = blend_u16_sse2(_mm_unpackhi_epi8(src, zero), _mm_unpackhi_epi8(dst, zero));
+            out = _mm_packus_epi16(lo, hi);
+        }
+        if (dst_cn == 4) {
+            // keep the destination's own alpha
+            out = _mm_or_si128(_mm_andnot_si128(alpha_lane, out), _mm_and_si128(alpha_lane, dst));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(d), out);
+        } else {
+            alignas(16) uint32_t px[4];
+            _mm_store_si128(reinterpret_cast<__m128i*>(px), out);
+            store_bgr(d, px[0]);
+            store_bgr(d + 3, px[1]);
+            store_bgr(d + 6, px[2]);
+            store_bgr(d + 9, px[3]);
+        }
+    }
+    blend_row_scalar(s, d, dst_cn, width - x);
+}
+
+KFC_TARGET_AVX2
+inline __m256i blend_u16_avx2(__m256i s, __m256i d) {
+    const __m256i c255 = _mm256_set1_epi16(255);
+    const __m256i c128 = _mm256_set1_epi16(128);
+    __m256i a = _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(s, 0xFF), 0xFF);
+    __m256i t = _mm256_add_epi16(_mm256_add_epi16(_mm256_mullo_epi16(s, a),
+                                                  _mm256_mullo_epi16(d, _mm256_sub_epi16(c255, a))), c128);
+    return _mm256_srli_epi16(_mm256_add_epi16(t, _mm256_srli_epi16(t, 8)), 8);
+}
+
+KFC_TARGET_AVX2
+void blend_row_avx2(const uint8_t* s, uint8_t* d, int dst_cn, int width) {
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i ones = _mm256_set1_epi8(static_cast<char>(0xFF));
+    const __m256i alpha_lane = _mm256_set1_epi32(static_cast<int>(0xFF000000u));
+    const unsigned alpha_bits = 0x88888888u;
+    const __m128i expand_lo = _mm_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+    const __m128i expand_hi = _mm_setr_epi8(4, 5, 6, -1, 7, 8, 9, -1, 10, 11, 12, -1, 13, 14, 15, -1);
+    const __m128i compact = _mm_setr_epi8(0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1);
+    int x = 0;
+    for (; x + 8 <= width; x += 8, s += 32, d += 8 * dst_cn) {
+        __m256i src = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s));
+        if ((static_cast<unsigned>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(src, zero))) & alpha_bits) == alpha_bits) continue;
+        bool opaque = (static_cast<unsigned>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(src, ones))) & alpha_bits) == alpha_bits;
+
+        __m256i dst;
+        if (dst_cn == 4) {
+            dst = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(d));
+        } else {
+            // 8 BGR pixels are 24 bytes: read bytes 0..15 and 8..23 (never past
+            // the pixels we own) and spread each half to BGRx
+            __m128i d_lo = _mm_loadu_si128(reinterpret_cast<const __m128i*>(d));
+            __m128i d_hi = _mm_loadu_si128(reinterpret_cast<const __m128i*>(d + 8));
+            dst = _mm256_inserti128_si256(_mm256_castsi128_si256(_mm_shuffle_epi8(d_lo, expand_lo)),
+                                          _mm_shuffle_epi8(d_hi, expand_hi), 1);
+        }
+        __m256i out;
+        if (opaque) {
+            out = src;
+        } else {
+            // unpack/pack both work per 128-bit lane, so pixel order is preserved
+            __m256i lo = blend_u16_avx2(_mm256_unpacklo_epi8(src, zero), _mm256_unpacklo_epi8(dst, zero));
+            __m256i hi = blend_u16_avx2(_mm256_unpackhi_epi8(src, zero), _mm256_unpackhi_epi8(dst, zero));
+            out = _mm256_packus_epi16(lo, hi);
+        }
+        if (dst_cn == 4) {
+            out = _mm256_or_si256(_mm256_andnot_si256(alpha_lane, out), _mm256_and_si256(alpha_lane, dst));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(d), out);
+        } else {
+            // pack BGRx back to 24 bytes and write them as bytes 0..15 and 8..23
+            __m128i c_lo = _mm_shuffle_epi8(_mm256_castsi256_si128(out), compact);
+            __m128i c_hi = _mm_shuffle_epi8(_mm256_extracti128_si256(out, 1), compact);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(d), _mm_or_si128(c_lo, _mm_slli_si128(c_hi, 12)));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(d + 8), _mm_or_si128(_mm_srli_si128(c_lo, 8), _mm_slli_si128(c_hi, 4)));
+        }
+    }
+    blend_row_sse2(s, d, dst_cn, width - x);
+}
+
+BlendIsa detect_isa() {
+#if defined(_MSC_VER) && !defined(__clang__)
+    int info[4];
+    __cpuid(info, 0);
+    int max_leaf = info[0];
+    __cpuid(info, 1);
+    bool sse2 = (info[3] & (1 << 26)) != 0;
+    bool osxsave = (info[2] & (1 << 27)) != 0;
+    bool avx = (info[2] & (1 << 28)) != 0;
+    if (osxsave && avx && max_leaf >= 7 && (_xgetbv(0) & 0x6) == 0x6) {
+        __cpuidex(info, 7, 0);
+        if (info[1] & (1 << 5)) return BlendIsa::AVX2;
+    }
+    return sse2 ? BlendIsa::SSE2 : BlendIsa::Scalar;
+#else
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) return BlendIsa::AVX2;
+    if (__builtin_cpu_supports("sse2")) return BlendIsa::SSE2;
+    return BlendIsa::Scalar;
+#endif
+}
+
+#else
+
+BlendIsa detect_isa() { return BlendIsa::Scalar; }
+
+#endif
+
+} // namespace
+
+BlendIsa blend_best_isa() {
+    static const BlendIsa best = detect_isa();
+    return best;
+}
+
+const char* blend_isa_name(BlendIsa isa) {
+    switch (isa) {
+        case BlendIsa::AVX2: return "avx2";
+        case BlendIsa::SSE2: return "sse2";
+        default: return "scalar";
+    }
+}
+
+void blend_bgra_over(const uint8_t* src, size_t src_step,
+                     uint8_t* dst, size_t dst_step, int dst_cn,
+                     int width, int height, BlendIsa isa) {
+    if (!src || !dst || width <= 0 || height <= 0 || (dst_cn != 3 && dst_cn != 4)) return;
+    if (static_cast<int>(isa) > static_cast<int>(blend_best_isa())) isa = blend_best_isa();
+
+    void (*row_fn)(const uint8_t*, uint8_t*, int, int) = blend_row_scalar;
+#ifdef KFC_BLEND_X86
+    if (isa == BlendIsa::AVX2) row_fn = blend_row_avx2;
+    else if (isa == BlendIsa::SSE2) row_fn = blend_row_sse2;
+#endif
+    for (int y = 0; y < height; ++y) {
+        row_fn(src + y * src_step, dst + y * dst_step, dst_cn, width);
+    }
+}
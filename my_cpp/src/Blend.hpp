@@ -0,0 +1,25 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+// 8-bit BGRA-over-BGR(A) alpha blend used by every sprite blit.
+// out = (src * a + dst * (255 - a)) / 255, rounded; a destination alpha
+// channel (dst_cn == 4) is left untouched. Fully transparent and fully opaque
+// spans take skip/copy fast paths, which is what most sprite pixels are.
+
+enum class BlendIsa { Scalar, SSE2, AVX2 };
+
+// Best instruction set supported by this CPU, detected once.
+BlendIsa blend_best_isa();
+const char* blend_isa_name(BlendIsa isa);
+
+// Runs on `isa` if the CPU supports it, otherwise on the best available one.
+void blend_bgra_over(const uint8_t* src, size_t src_step,
+                     uint8_t* dst, size_t dst_step, int dst_cn,
+                     int width, int height, BlendIsa isa);
+
+inline void blend_bgra_over(const uint8_t* src, size_t src_step,
+                            uint8_t* dst, size_t dst_step, int dst_cn,
+                            int width, int height) {
+    blend_bgra_over(src, src_step, dst, dst_step, dst_cn, width, height, blend_best_isa());
+}
@@ -0,0 +1,159 @@
+#pragma once
+#include "Bitboard.hpp"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <queue>
+#include <utility>
+#include <vector>
+
+// One piece holding one cell for [enter_ms, leave_ms)
+struct CellSpan {
+    int8_t row, col;
+    int64_t enter_ms, leave_ms;
+    bool capturable; // can_be_captured() of the state the piece is in meanwhile
+};
+
+// Two pieces in the same cell: the one that came in later (attacker) meets
+// the one already there (occupant), which can be captured at that moment.
+struct Encounter {
+    int64_t at_ms;
+    int8_t row, col;
+    PieceHandle attacker, occupant;
+    uint32_t attacker_version, occupant_version;
+};
+
+// When each cell is held by which piece, as time intervals computed from the
+// pieces' paths (start, direction, speed, start time) rather than sampled
+// positions, so a piece crossing another between two frames is still seen
+// and the outcome does not depend on the frame rate. Encounters come out in
+// time order; replacing a piece's spans drops its pending encounters.
+class CellTimeline {
+public:
+    static constexpr int64_t FOREVER = std::numeric_limits<int64_t>::max();
+
+    void clear() {
+        for (auto& cell : _cells) cell.clear();
+        _held.clear();
+        _version.clear();
+        _pending = {};
+    }
+
+    // Replaces piece h's spans and queues its encounters with the other
+    // pieces' spans in the same cells, one O(1) overlap test per pair.
+    void reserve(PieceHandle h, const std::vector<CellSpan>& spans) {
+        release(h);
+        for (const auto& s : spans) {
+            if (!on_board(s.row, s.col) || s.enter_ms >= s.leave_ms) continue;
+            int sq = square_of(s.row, s.col);
+            auto& cell = _cells[sq];
+            for (const auto& o : cell) {
+                if (o.piece != h) _meet(h, s, o.piece, o.span);
+            }
+            cell.push_back({h, s});
+            _held[h].push_back(static_cast<int8_t>(sq));
+        }
+    }
+
+    // Only the cells h holds are touched
+    void release(PieceHandle h) {
+        if (h >= _version.size()) _version.resize(h + 1, 0);
+        if (h >= _held.size()) _held.resize(h + 1);
+        ++_version[h];
+        for (int8_t sq : _held[h]) {
+            auto& cell = _cells[sq];
+            cell.erase(std::remove_if(cell.begin(), cell.end(), [h](const Held& x) { return x.piece == h; }), cell.end());
+        }
+        _held[h].clear();
+    }
+
+    // Time of the earliest live encounter, FOREVER when there is none
+    int64_t next_ms() {
+        _drop_stale();
+        return _pending.empty() ? FOREVER : _pending.top().at_ms;
+    }
+
+    bool pop(Encounter& out) {
+        _drop_stale();
+        if (_pending.empty()) return false;
+        out = _pending.top();
+        _pending.pop();
+        return true;
+    }
+
+    // Cells crossed by a straight move from `src` to `dst` at `speed` cells/s
+    // starting at start_ms, as the rounded position MoveBatch produces. The
+    // last cell is held from when the piece rounds into it until arrive_ms.
+    static void trace_line(std::pair<int, int> src, std::pair<int, int> dst, float speed, int64_t start_ms,
+                           int64_t arrive_ms, bool capturable, std::vector<CellSpan>& out) {
+        float dr = static_cast<float>(dst.first - src.first), dc = static_cast<float>(dst.second - src.second);
+        float len = std::hypot(dr, dc);
+        if (len == 0.0f || !(speed > 0.0f)) return;
+        float ur = dr / len, uc = dc / len;
+        // Distances along the path where a coordinate crosses a half-cell line
+        std::vector<float> cuts;
+        auto add_cuts = [&](int a, int b, float u) {
+            if (a == b) return;
+            int step = b > a ? 1 : -1;
+            for (int k = a; k != b; k += step) cuts.push_back((k + 0.5f * step - a) / u);
+        };
+        add_cuts(src.first, dst.first, ur);
+        add_cuts(src.second, dst.second, uc);
+        std::sort(cuts.begin(), cuts.end());
+        size_t n = cuts.size();
+        float from = 0.0f;
+        int64_t enter = start_ms;
+        for (size_t i = 0; i <= n; ++i) {
+            float to = i < n ? cuts[i] : len;
+            if (i < n && to <= from) continue;
+            float mid = 0.5f * (from + to);
+            int8_t row = static_cast<int8_t>(std::lround(src.first + ur * mid));
+            int8_t col = static_cast<int8_t>(std::lround(src.second + uc * mid));
+            int64_t leave = i < n ? start_ms + static_cast<int64_t>(std::ceil(to / speed * 1000.0f)) : arrive_ms;
+            if (!out.empty() && out.back().row == row && out.back().col == col && out.back().leave_ms == enter) {
+                out.back().leave_ms = leave;
+            } else {
+                out.push_back({row, col, enter, leave, capturable});
+            }
+            from = to;
+            enter = leave;
+        }
+    }
+
+private:
+    struct Held {
+        PieceHandle piece;
+        CellSpan span;
+    };
+    struct Later {
+        bool operator()(const Encounter& a, const Encounter& b) const { return a.at_ms > b.at_ms; }
+    };
+
+    std::array<std::vector<Held>, SQUARE_COUNT> _cells;
+    std::vector<std::vector<int8_t>> _held; // squares each piece has spans in
+    std::vector<uint32_t> _version; // bumped whenever a piece's spans change
+    std::priority_queue<Encounter, std::vector<Encounter>, Later> _pending;
+
+    void _meet(PieceHandle a, const CellSpan& sa, PieceHandle b, const CellSpan& sb) {
+        int64_t at = std::max(sa.enter_ms, sb.enter_ms);
+        if (at >= std::min(sa.leave_ms, sb.leave_ms)) return;
+        // Arriving together has no attacker; neither is taken
+        if (sa.enter_ms == sb.enter_ms) return;
+        bool a_later = sa.enter_ms > sb.enter_ms;
+        const CellSpan& occupied = a_later ? sb : sa;
+        if (!occupied.capturable) return;
+        PieceHandle attacker = a_later ? a : b, occupant = a_later ? b : a;
+        if (std::max(attacker, occupant) >= _version.size()) _version.resize(std::max(attacker, occupant) + 1, 0);
+        _pending.push({at, sa.row, sa.col, attacker, occupant, _version[attacker], _version[occupant]});
+    }
+
+    void _drop_stale() {
+        while (!_pending.empty()) {
+            const Encounter& e = _pending.top();
+            if (_version[e.attacker] == e.attacker_version && _version[e.occupant] == e.occupant_version) return;
+            _pending.pop();
+        }
+    }
+};
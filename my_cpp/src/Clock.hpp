@@ -0,0 +1,101 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+
+// Source of game time: milliseconds since the clock was created.
+// Everything that stamps a Command or starts a physics/graphics timer reads
+// this, so swapping the clock changes the speed of the whole game.
+class Clock {
+public:
+    virtual ~Clock() = default;
+    virtual int64_t now_ms() const = 0;
+    // Waits `ms` of game time. Real clocks block; a manual clock just advances,
+    // which lets headless games run as fast as the CPU allows.
+    virtual void sleep_for_ms(int64_t ms) = 0;
+    // False when time does not follow the wall clock, so pacing frames
+    // against real time would only slow the game down.
+    virtual bool is_realtime() const { return true; }
+};
+
+class RealTimeClock : public Clock {
+public:
+    RealTimeClock() : _start(std::chrono::steady_clock::now()) {}
+
+    int64_t now_ms() const override {
+        return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - _start).count();
+    }
+
+    void sleep_for_ms(int64_t ms) override {
+        if (ms > 0) std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+    }
+
+private:
+    std::chrono::steady_clock::time_point _start;
+};
+
+// Wall-clock time multiplied by a fractional factor (0.5 = slow motion,
+// 4.0 = fast-forward). Changing the factor does not make time jump.
+class ScaledClock : public Clock {
+public:
+    explicit ScaledClock(double factor = 1.0)
+        : _base_real(std::chrono::steady_clock::now()), _base_ms(0.0), _factor(factor > 0.0 ? factor : 1.0) {}
+
+    int64_t now_ms() const override {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return static_cast<int64_t>(_now_locked());
+    }
+
+    void sleep_for_ms(int64_t ms) override {
+        double factor;
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            factor = _factor;
+        }
+        if (ms > 0) std::this_thread::sleep_for(std::chrono::duration<double, std::milli>(ms / factor));
+    }
+
+    double factor() const {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _factor;
+    }
+
+    void set_factor(double factor) {
+        if (factor <= 0.0) return;
+        std::lock_guard<std::mutex> lock(_mutex);
+        auto real = std::chrono::steady_clock::now();
+        _base_ms = _now_locked(real);
+        _base_real = real;
+        _factor = factor;
+    }
+
+private:
+    mutable std::mutex _mutex;
+    std::chrono::steady_clock::time_point _base_real;
+    double _base_ms;
+    double _factor;
+
+    double _now_locked(std::chrono::steady_clock::time_point real = std::chrono::steady_clock::now()) const {
+        return _base_ms + std::chrono::duration<double, std::milli>(real - _base_real).count() * _factor;
+    }
+};
+
+// Time only moves when told to. For tests, replays and headless simulation.
+class ManualClock : public Clock {
+public:
+    explicit ManualClock(int64_t start_ms = 0) : _now(start_ms) {}
+
+    int64_t now_ms() const override { return _now.load(std::memory_order_acquire); }
+    void sleep_for_ms(int64_t ms) override { advance(ms); }
+    bool is_realtime() const override { return false; }
+
+    void advance(int64_t ms) {
+        if (ms > 0) _now.fetch_add(ms, std::memory_order_acq_rel);
+    }
+    void set(int64_t ms) { _now.store(ms, std::memory_order_release); }
+
+private:
+    std::atomic<int64_t> _now;
+};
@@ -1,12 +1,69 @@
 #pragma once
+#include "SlotMap.hpp"
 #include <string>
+#include <string_view>
 #include <vector>
 #include <any>
+#include <cstdint>
 #include <sstream>
 #include <iostream>
+#include <type_traits>
 #include <typeinfo>
 #include <utility>
 
+// Events the state machines react to (the "event" column of transitions.csv)
+enum class EventKind : uint8_t { None = 0, Idle, Move, Jump, Done, Count };
+
+inline EventKind event_kind_of(std::string_view name) {
+    if (name == "idle") return EventKind::Idle;
+    if (name == "move") return EventKind::Move;
+    if (name == "jump") return EventKind::Jump;
+    if (name == "done") return EventKind::Done;
+    return EventKind::None;
+}
+
+inline const char* event_name(EventKind kind) {
+    switch (kind) {
+    case EventKind::Idle: return "idle";
+    case EventKind::Move: return "move";
+    case EventKind::Jump: return "jump";
+    case EventKind::Done: return "done";
+    default: return "";
+    }
+}
+
+struct CommandCell {
+    int8_t row, col;
+
+    std::pair<int, int> pair() const { return {row, col}; }
+    static CommandCell of(std::pair<int, int> cell) { return {static_cast<int8_t>(cell.first), static_cast<int8_t>(cell.second)}; }
+};
+
+// Fixed-size command used on the hot path (input queue, State::on_command,
+// physics "done" events): copying one never allocates. `piece` is the piece's
+// key in Game::pieces, checked when the command is handled, so a command for a
+// piece captured meanwhile is dropped; internal events leave it empty.
+// idle/jump-in-place carry one cell (src == dst), move/jump carry two.
+struct TypedCommand {
+    int32_t timestamp; // ms since game start
+    SlotKey piece;
+    EventKind kind;
+    uint8_t cell_count;
+    CommandCell src, dst;
+
+    static TypedCommand idle(int timestamp, std::pair<int, int> cell, SlotKey piece = {}) {
+        return {timestamp, piece, EventKind::Idle, 1, CommandCell::of(cell), CommandCell::of(cell)};
+    }
+    static TypedCommand move(int timestamp, std::pair<int, int> src, std::pair<int, int> dst, SlotKey piece = {}) {
+        return {timestamp, piece, EventKind::Move, 2, CommandCell::of(src), CommandCell::of(dst)};
+    }
+    // Carries the cell the piece ended up in, for the next state's reset
+    static TypedCommand done(int timestamp, std::pair<int, int> cell, SlotKey piece = {}) {
+        return {timestamp, piece, EventKind::Done, 1, CommandCell::of(cell), CommandCell::of(cell)};
+    }
+};
+static_assert(std::is_trivially_copyable_v<TypedCommand> && sizeof(TypedCommand) <= 16, "TypedCommand must stay a small POD");
+
 class Command {
 public:
     int timestamp;           // ms since game start
@@ -53,3 +110,33 @@ public:
         return os << cmd.to_string();
     }
 };
+
+// Conversion from the string/std::any form. Cells may be std::vector<int> or
+// std::pair<int, int>; anything else leaves them out (cell_count says how many
+// were read). The piece key is not known from an id string: pass it in.
+inline TypedCommand to_typed(const Command& cmd, SlotKey piece = {}) {
+    TypedCommand out{cmd.timestamp, piece, event_kind_of(cmd.type), 0, {0, 0}, {0, 0}};
+    CommandCell* cells[2] = {&out.src, &out.dst};
+    for (size_t i = 0; i < cmd.params.size() && i < 2; ++i) {
+        const std::any& p = cmd.params[i];
+        if (const auto* v = std::any_cast<std::vector<int>>(&p)) {
+            if (v->size() < 2) break;
+            *cells[i] = CommandCell::of({(*v)[0], (*v)[1]});
+        } else if (const auto* c = std::any_cast<std::pair<int, int>>(&p)) {
+            *cells[i] = CommandCell::of(*c);
+        } else {
+            break;
+        }
+        ++out.cell_count;
+    }
+    if (out.cell_count == 1) out.dst = out.src;
+    return out;
+}
+
+// Back to the old form (cells as std::pair), for logs and publishers.
+inline Command to_command(const TypedCommand& cmd, const std::string& piece_id) {
+    std::vector<std::any> params;
+    if (cmd.cell_count >= 1) params.emplace_back(cmd.src.pair());
+    if (cmd.cell_count >= 2) params.emplace_back(cmd.dst.pair());
+    return Command(cmd.timestamp, piece_id, event_name(cmd.kind), params);
+}
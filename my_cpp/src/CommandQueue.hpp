@@ -0,0 +1,54 @@
+#pragma once
+#include "Command.hpp"
+#include <array>
+#include <cstddef>
+#include <mutex>
+
+// Fixed-capacity FIFO of TypedCommand shared by the keyboard producers and
+// the game loop. Storage is inline, so push/pop never allocate; a push to a
+// full queue is dropped and counted (one frame never sees that many inputs).
+class CommandQueue {
+public:
+    static constexpr size_t CAPACITY = 256;
+
+    bool push(const TypedCommand& cmd) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (_size == CAPACITY) {
+            ++_dropped;
+            return false;
+        }
+        _items[(_head + _size) % CAPACITY] = cmd;
+        ++_size;
+        return true;
+    }
+
+    // Pops the oldest command into `out`; false when empty.
+    bool pop(TypedCommand& out) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (_size == 0) return false;
+        out = _items[_head];
+        _head = (_head + 1) % CAPACITY;
+        --_size;
+        return true;
+    }
+
+    bool empty() const {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _size == 0;
+    }
+
+    size_t size() const {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _size;
+    }
+
+    size_t dropped() const {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _dropped;
+    }
+
+private:
+    mutable std::mutex _mutex;
+    std::array<TypedCommand, CAPACITY> _items{};
+    size_t _head = 0, _size = 0, _dropped = 0;
+};
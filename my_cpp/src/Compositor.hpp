@@ -0,0 +1,130 @@
+#pragma once
+#include <opencv2/opencv.hpp>
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <vector>
+
+// Builds the window frame from three persistent layers:
+//   BACKGROUND - board squares and side panels, rendered into its own buffer
+//   PIECES     - piece sprites
+//   OVERLAY    - cursors, selections
+// Changes are reported as dirty rectangles per layer. compose() re-composites
+// only those rectangles into the persistent `frame`; everything outside them
+// keeps last frame's pixels. When nothing changed, compose() does no work.
+class Compositor {
+public:
+    enum Layer { BACKGROUND = 0, PIECES, OVERLAY, LAYER_COUNT };
+    // `target` is the dirty region of the layer's buffer (a sub-Mat), `region`
+    // its position in frame coordinates: draw at (x - region.x, y - region.y).
+    // OpenCV clips drawing calls to the sub-Mat.
+    using Painter = std::function<void(cv::Mat& target, const cv::Rect& region)>;
+
+    struct Stats {
+        size_t dirty_rects = 0;  // rectangles re-composited by the last compose()
+        size_t dirty_pixels = 0; // pixels re-composited by the last compose()
+        size_t frames = 0;       // compose() calls
+        size_t idle_frames = 0;  // compose() calls that had nothing to do
+        size_t total_dirty_pixels = 0;
+    };
+
+    cv::Mat frame; // composed BGR output, reused between frames
+
+    Compositor(int width, int height)
+        : frame(height, width, CV_8UC3, cv::Scalar::all(0)),
+          _background(height, width, CV_8UC3, cv::Scalar::all(0)),
+          _bounds(0, 0, width, height) {
+        invalidate_all();
+    }
+
+    void set_painter(Layer layer, Painter painter) {
+        _painters[layer] = std::move(painter);
+        invalidate(layer);
+    }
+
+    void invalidate(Layer layer) { invalidate(layer, _bounds); }
+
+    void invalidate(Layer layer, const cv::Rect& rect) {
+        cv::Rect r = rect & _bounds;
+        if (r.area() > 0) _add_rect(_dirty[layer], r);
+    }
+
+    void invalidate_all() {
+        for (int i = 0; i < LAYER_COUNT; ++i) invalidate(static_cast<Layer>(i));
+    }
+
+    bool is_dirty() const {
+        for (int i = 0; i < LAYER_COUNT; ++i)
+            if (!_dirty[i].empty()) return true;
+        return false;
+    }
+
+    const Stats& stats() const { return _stats; }
+
+    // Returns true when any part of `frame` was rebuilt.
+    bool compose() {
+        ++_stats.frames;
+        _stats.dirty_rects = 0;
+        _stats.dirty_pixels = 0;
+        if (!is_dirty()) {
+            ++_stats.idle_frames;
+            return false;
+        }
+        for (const auto& r : _dirty[BACKGROUND]) {
+            cv::Mat bg = _background(r);
+            bg.setTo(cv::Scalar::all(0));
+            if (_painters[BACKGROUND]) _painters[BACKGROUND](bg, r);
+        }
+        // Every layer above the background is drawn straight onto the frame,
+        // so a dirty rectangle of any layer is rebuilt from the background up.
+        std::vector<cv::Rect> rects;
+        for (int i = 0; i < LAYER_COUNT; ++i)
+            for (const auto& r : _dirty[i]) _add_rect(rects, r);
+        for (const auto& r : rects) {
+            cv::Mat out = frame(r);
+            _background(r).copyTo(out);
+            if (_painters[PIECES]) _painters[PIECES](out, r);
+            if (_painters[OVERLAY]) _painters[OVERLAY](out, r);
+            _stats.dirty_pixels += static_cast<size_t>(r.area());
+        }
+        _stats.dirty_rects = rects.size();
+        _stats.total_dirty_pixels += _stats.dirty_pixels;
+        for (int i = 0; i < LAYER_COUNT; ++i) _dirty[i].clear();
+        return true;
+    }
+
+private:
+    // Past this many rectangles per list, merging everything is cheaper than
+    // walking the list.
+    static constexpr size_t MAX_RECTS = 64;
+
+    cv::Mat _background;
+    cv::Rect _bounds;
+    Painter _painters[LAYER_COUNT];
+    std::vector<cv::Rect> _dirty[LAYER_COUNT];
+    Stats _stats;
+
+    // Adds `r`, merging it with every rectangle it overlaps so no pixel is
+    // composited twice.
+    static void _add_rect(std::vector<cv::Rect>& rects, cv::Rect r) {
+        bool merged = true;
+        while (merged) {
+            merged = false;
+            for (size_t i = 0; i < rects.size(); ++i) {
+                if ((rects[i] & r).area() > 0) {
+                    r |= rects[i];
+                    rects[i] = rects.back();
+                    rects.pop_back();
+                    merged = true;
+                    break;
+                }
+            }
+        }
+        rects.push_back(r);
+        if (rects.size() > MAX_RECTS) {
+            cv::Rect all = rects[0];
+            for (const auto& x : rects) all |= x;
+            rects.assign(1, all);
+        }
+    }
+};
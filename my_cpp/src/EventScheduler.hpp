@@ -0,0 +1,120 @@
+#pragma once
+#include "Bitboard.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+// Pending deadlines of timed states (move arrival, rest expiry, jump landing),
+// at most one per piece: a piece is in one state at a time. An indexed binary
+// min-heap - schedule/cancel are O(log n) and find the piece's entry through
+// `_slot` instead of searching, and nothing is looked at until it is due.
+// Equal deadlines come out in the order they were scheduled.
+class EventScheduler {
+public:
+    static constexpr int64_t NEVER = std::numeric_limits<int64_t>::max();
+
+    struct Entry {
+        int64_t due_ms;
+        uint64_t seq;
+        PieceHandle piece;
+    };
+
+    size_t size() const { return _heap.size(); }
+    bool empty() const { return _heap.empty(); }
+
+    void clear() {
+        _heap.clear();
+        _slot.clear();
+    }
+
+    // Sets (or moves) piece h's deadline
+    void schedule(PieceHandle h, int64_t due_ms) {
+        if (h >= _slot.size()) _slot.resize(h + 1, NONE);
+        Entry e{due_ms, _seq++, h};
+        size_t i = _slot[h];
+        if (i == NONE) {
+            i = _heap.size();
+            _heap.push_back(e);
+            _slot[h] = i;
+            _sift_up(i);
+            return;
+        }
+        bool earlier = _before(e, _heap[i]);
+        _heap[i] = e;
+        if (earlier) _sift_up(i);
+        else _sift_down(i);
+    }
+
+    void cancel(PieceHandle h) {
+        if (h >= _slot.size() || _slot[h] == NONE) return;
+        _remove_at(_slot[h]);
+    }
+
+    bool scheduled(PieceHandle h) const { return h < _slot.size() && _slot[h] != NONE; }
+
+    // NEVER when nothing is pending
+    int64_t next_due() const { return _heap.empty() ? NEVER : _heap[0].due_ms; }
+
+    // Takes the earliest entry if it is due at now_ms; false otherwise
+    bool pop_due(int64_t now_ms, Entry& out) {
+        if (_heap.empty() || _heap[0].due_ms > now_ms) return false;
+        out = _heap[0];
+        _remove_at(0);
+        return true;
+    }
+
+private:
+    static constexpr size_t NONE = static_cast<size_t>(-1);
+    std::vector<Entry> _heap;
+    std::vector<size_t> _slot; // PieceHandle -> index in _heap
+    uint64_t _seq = 0;
+
+    static bool _before(const Entry& a, const Entry& b) {
+        return a.due_ms < b.due_ms || (a.due_ms == b.due_ms && a.seq < b.seq);
+    }
+
+    void _place(size_t i, const Entry& e) {
+        _heap[i] = e;
+        _slot[e.piece] = i;
+    }
+
+    void _sift_up(size_t i) {
+        Entry e = _heap[i];
+        while (i > 0) {
+            size_t parent = (i - 1) / 2;
+            if (!_before(e, _heap[parent])) break;
+            _place(i, _heap[parent]);
+            i = parent;
+        }
+        _place(i, e);
+    }
+
+    void _sift_down(size_t i) {
+        Entry e = _heap[i];
+        size_t n = _heap.size();
+        for (;;) {
+            size_t child = 2 * i + 1;
+            if (child >= n) break;
+            if (child + 1 < n && _before(_heap[child + 1], _heap[child])) ++child;
+            if (!_before(_heap[child], e)) break;
+            _place(i, _heap[child]);
+            i = child;
+        }
+        _place(i, e);
+    }
+
+    void _remove_at(size_t i) {
+        _slot[_heap[i].piece] = NONE;
+        size_t last = _heap.size() - 1;
+        if (i != last) {
+            Entry moved = _heap[last];
+            _heap.pop_back();
+            _place(i, moved);
+            _sift_up(i);
+            _sift_down(_slot[moved.piece]);
+        } else {
+            _heap.pop_back();
+        }
+    }
+};
@@ -0,0 +1,80 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+// What went wrong in per-frame work. The frame loop does not throw: update,
+// collide and draw return one of these and the game counts it per subsystem
+// instead of swallowing it in a catch. Load-time failures still throw.
+enum class Fault : uint8_t {
+    None = 0,
+    NoState,         // piece without a state
+    NoPhysics,       // state without physics
+    NoGraphics,      // state without graphics
+    NoFrame,         // no sprite frame for the piece's state
+    ImageNotLoaded,  // drawing from or onto an empty image
+    BadMoveCommand,  // move without two cells, or a state without move rules
+    WrongSourceCell, // move does not start at the piece's cell
+    StalePiece,      // handle/key of a piece that was removed
+    ZeroSpeed,       // move state configured with no speed
+    Count
+};
+
+enum class Subsystem : uint8_t { Input, Update, Collide, Draw, Count };
+
+inline const char* fault_name(Fault f) {
+    static constexpr const char* names[] = {"none", "no_state", "no_physics", "no_graphics", "no_frame",
+                                            "image_not_loaded", "bad_move_command", "wrong_source_cell",
+                                            "stale_piece", "zero_speed"};
+    return f < Fault::Count ? names[static_cast<size_t>(f)] : "?";
+}
+
+inline const char* subsystem_name(Subsystem s) {
+    static constexpr const char* names[] = {"input", "update", "collide", "draw"};
+    return s < Subsystem::Count ? names[static_cast<size_t>(s)] : "?";
+}
+
+// Fault totals per subsystem and kind. Written by the game thread, readable
+// from any thread while the game runs (relaxed atomics: counts, not sync).
+class FaultCounters {
+public:
+    // Returns f so call sites can pass a result through
+    Fault record(Subsystem s, Fault f) {
+        if (f == Fault::None) return f;
+        _counts[_index(s, f)].fetch_add(1, std::memory_order_relaxed);
+        _last[static_cast<size_t>(s)].store(f, std::memory_order_relaxed);
+        return f;
+    }
+
+    uint64_t count(Subsystem s, Fault f) const { return _counts[_index(s, f)].load(std::memory_order_relaxed); }
+
+    uint64_t count(Subsystem s) const {
+        uint64_t n = 0;
+        for (size_t f = 1; f < FAULTS; ++f) n += count(s, static_cast<Fault>(f));
+        return n;
+    }
+
+    uint64_t total() const {
+        uint64_t n = 0;
+        for (size_t s = 0; s < SUBSYSTEMS; ++s) n += count(static_cast<Subsystem>(s));
+        return n;
+    }
+
+    // Most recent fault of the subsystem, None if it never had one
+    Fault last(Subsystem s) const { return _last[static_cast<size_t>(s)].load(std::memory_order_relaxed); }
+
+    void reset() {
+        for (auto& c : _counts) c.store(0, std::memory_order_relaxed);
+        for (auto& l : _last) l.store(Fault::None, std::memory_order_relaxed);
+    }
+
+private:
+    static constexpr size_t SUBSYSTEMS = static_cast<size_t>(Subsystem::Count);
+    static constexpr size_t FAULTS = static_cast<size_t>(Fault::Count);
+
+    static size_t _index(Subsystem s, Fault f) { return static_cast<size_t>(s) * FAULTS + static_cast<size_t>(f); }
+
+    std::array<std::atomic<uint64_t>, SUBSYSTEMS * FAULTS> _counts{};
+    std::array<std::atomic<Fault>, SUBSYSTEMS> _last{};
+};
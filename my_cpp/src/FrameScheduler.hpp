@@ -0,0 +1,77 @@
+#pragma once
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <thread>
+
+// Paces the game loop at a target frame rate. Each frame is
+//   begin_frame() -> poll input, update, render -> end_frame()
+// end_frame() measures the work, then sleeps only for what is left of the
+// frame budget. Deadlines are absolute, so sleep overshoot does not
+// accumulate; a frame whose work overruns its deadline is counted as missed
+// and the schedule restarts from now instead of trying to catch up.
+class FrameScheduler {
+public:
+    using clock_type = std::chrono::steady_clock;
+
+    struct Stats {
+        uint64_t frames = 0;
+        uint64_t missed_deadlines = 0;
+        double last_work_ms = 0.0;
+        double max_work_ms = 0.0;
+        double total_work_ms = 0.0;
+
+        double avg_work_ms() const { return frames ? total_work_ms / frames : 0.0; }
+    };
+
+    explicit FrameScheduler(double target_fps = 60.0) { set_target_fps(target_fps); }
+
+    void set_target_fps(double fps) {
+        if (fps <= 0.0) fps = 60.0;
+        _target_fps = fps;
+        _period = std::chrono::duration_cast<clock_type::duration>(std::chrono::duration<double>(1.0 / fps));
+        _started = false;
+    }
+
+    double target_fps() const { return _target_fps; }
+    clock_type::duration period() const { return _period; }
+    double period_ms() const { return std::chrono::duration<double, std::milli>(_period).count(); }
+
+    void begin_frame() {
+        _frame_start = clock_type::now();
+        if (!_started) {
+            _deadline = _frame_start + _period;
+            _started = true;
+        }
+    }
+
+    // Returns false when the frame missed its deadline.
+    bool end_frame() {
+        auto now = clock_type::now();
+        double work_ms = std::chrono::duration<double, std::milli>(now - _frame_start).count();
+        ++_stats.frames;
+        _stats.last_work_ms = work_ms;
+        _stats.total_work_ms += work_ms;
+        _stats.max_work_ms = std::max(_stats.max_work_ms, work_ms);
+
+        bool on_time = now <= _deadline;
+        if (!on_time) {
+            ++_stats.missed_deadlines;
+            _deadline = now + _period;
+            return false;
+        }
+        std::this_thread::sleep_until(_deadline);
+        _deadline += _period;
+        return true;
+    }
+
+    const Stats& stats() const { return _stats; }
+
+private:
+    double _target_fps = 60.0;
+    clock_type::duration _period{};
+    clock_type::time_point _frame_start{};
+    clock_type::time_point _deadline{};
+    bool _started = false;
+    Stats _stats;
+};
@@ -1,232 +1,281 @@
 // Required includes for Game class implementation
 #include "Game.hpp"
+#include "AssetPack.hpp"
 #include <opencv2/opencv.hpp>
 #include <iostream>
+#include <cmath>
 #include <cstdint>
 #include <thread>
 #include <chrono>
 #include <fstream>
 
 // Stub implementations to resolve linker errors (must come after includes)
-void Game::_add_side_labels(cv::Mat&) {}
 void Game::_draw_valid_moves() {}
 void Game::_check_pawn_promotion() {}
 
-void Game::_draw() {
-    try {
-        curr_board = clone_board();
-        if (curr_board.img.img.empty()) {
-            std::cout << "ERROR: cloned board image is empty!" << std::endl;
-            return;
+// Side panels: player titles, scores and the recent moves of each side.
+// Drawn into the background layer, so it only runs when a score or log changes.
+void Game::_add_side_labels(cv::Mat &img, cv::Point origin) {
+    auto text = [&](const std::string &s, int x, int y, double scale, const cv::Scalar &color, int thickness) {
+        cv::putText(img, s, cv::Point(x, y) - origin, cv::FONT_HERSHEY_SIMPLEX, scale, color, thickness);
+    };
+    // צד שמאל - שחקן שחור
+    text("BLACK PLAYER", 10, 30, 0.7, cv::Scalar(255, 255, 255), 2);
+    text("Score: " + std::to_string(score_black.get_score()), 10, 60, 0.6, cv::Scalar(0, 255, 0), 2);
+    text("Controls: WASD + Space", 10, 90, 0.4, cv::Scalar(200, 200, 200), 1);
+    text("Recent Moves:", 10, 130, 0.5, cv::Scalar(255, 255, 0), 1);
+
+    // צד ימין - שחקן לבן
+    int right_x = side_panel_width + board_size_px + 10;
+    text("WHITE PLAYER", right_x, 30, 0.7, cv::Scalar(255, 255, 255), 2);
+    text("Score: " + std::to_string(score_white.get_score()), right_x, 60, 0.6, cv::Scalar(0, 255, 0), 2);
+    text("Controls: -> <- ... + Enter", right_x, 90, 0.4, cv::Scalar(200, 200, 200), 1);
+    text("Recent Moves:", right_x, 130, 0.5, cv::Scalar(255, 255, 0), 1);
+
+    auto draw_log = [&](const std::vector<std::string> &log, int x) {
+        for (size_t i = 0; i < log.size() && i < 8; ++i) {
+            std::string display_move = log[i];
+            if (display_move.length() > 25) display_move = display_move.substr(0, 22) + "...";
+            text(display_move, x, 160 + static_cast<int>(i) * 20, 0.35, cv::Scalar(200, 200, 200), 1);
         }
-        for (auto &p : pieces) {
-            if (!p || !p->state || !p->state->physics) continue;
-            
-            // בדיקת תקינות פוינטר physics
-            void* physics_ptr = p->state->physics.get();
-            uintptr_t ptr_val = reinterpret_cast<uintptr_t>(physics_ptr);
-            if (ptr_val == 0xDDDDDDDDDDDDDDDD || ptr_val == 0 || ptr_val < 0x1000) {
-                continue; // דילוג על כלים פגומים
-            }
-            
-            try {
-                p->draw_on_board(curr_board, game_time_ms());
-            } catch (...) {
-                // שגיאה בציור - מדלגים
-            }
+    };
+    draw_log(black_moves_log, 10);
+    draw_log(white_moves_log, right_x);
+}
+
+cv::Rect Game::_panel_rect(bool white) const {
+    return cv::Rect(white ? side_panel_width + board_size_px : 0, 0, side_panel_width, board_size_px);
+}
+
+cv::Rect Game::_cell_rect(std::pair<int, int> cell) const {
+    int square_size = board_size_px / 8;
+    return cv::Rect(side_panel_width + cell.second * square_size, cell.first * square_size, square_size, square_size);
+}
+
+void Game::_push_moves_log(std::vector<std::string> &log, const std::string &move) {
+    log.push_back(move);
+    if (log.size() > 8) log.erase(log.begin());
+    compositor.invalidate(Compositor::BACKGROUND, _panel_rect(&log == &white_moves_log));
+}
+
+void Game::_paint_background(cv::Mat &img, const cv::Rect &region) {
+    cv::Point o = region.tl();
+    cv::rectangle(img, _panel_rect(false) - o, cv::Scalar(50, 150, 50), -1);
+    cv::rectangle(img, _panel_rect(true) - o, cv::Scalar(150, 50, 50), -1);
+    for (int r = 0; r < 8; r++) {
+        for (int c = 0; c < 8; c++) {
+            cv::Rect cell = _cell_rect({r, c});
+            if ((cell & region).area() == 0) continue;
+            cv::Scalar color = ((r + c) % 2 == 0) ? cv::Scalar(240, 217, 181) : cv::Scalar(181, 136, 99);
+            cv::rectangle(img, cell - o, color, -1);
         }
-    } catch (const std::exception& e) {
-        std::cout << "Error in _draw - board cloning failed: " << e.what() << std::endl;
-        return;
-    } catch (...) {
-        std::cout << "Unknown error in _draw - board cloning failed" << std::endl;
-        return;
     }
-    try {
-        // Create expanded image
-        expanded_board_img = cv::Mat::zeros(board_size_px, expanded_width, CV_8UC3);
-        // Left panel (white) - green
-        expanded_board_img(cv::Rect(0, 0, side_panel_width, board_size_px)) = cv::Scalar(50, 150, 50);
-        // Right panel (black) - blue
-        expanded_board_img(cv::Rect(side_panel_width + board_size_px, 0, side_panel_width, board_size_px)) = cv::Scalar(150, 50, 50);
-
-        // Convert board to BGR if needed
-        cv::Mat board_img = curr_board.img.img;
-        if (!board_img.empty()) {
-            if (board_img.channels() == 4) {
-                cv::cvtColor(board_img, board_img, cv::COLOR_BGRA2BGR);
+    if ((region & _panel_rect(false)).area() > 0 || (region & _panel_rect(true)).area() > 0) {
+        _add_side_labels(img, o);
+    }
+}
+
+void Game::_paint_pieces(cv::Mat &img, const cv::Rect &region) {
+    cv::Point o = region.tl();
+    for (const auto &ps : _painted_pieces) {
+        if (!ps.shown) continue;
+        cv::Rect clip = ps.rect & region;
+        if (clip.area() == 0) continue;
+        const Img *sprite = ps.sprite;
+        if (sprite && sprite->img.rows == ps.rect.height && sprite->img.cols == ps.rect.width) {
+            cv::Mat src = sprite->img(clip - ps.rect.tl());
+            cv::Mat dst = img(clip - o);
+            if (src.channels() == 4) {
+                blend_bgra_over(src.data, src.step, dst.data, dst.step, 3, clip.width, clip.height);
+            } else {
+                src.copyTo(dst);
             }
-            board_img.copyTo(expanded_board_img(cv::Rect(side_panel_width, 0, board_size_px, board_size_px)));
+        } else {
+            // אם אין תמונה - ציור עיגול פשוט
+            cv::Point center = (ps.rect.tl() + ps.rect.br()) / 2 - o;
+            int radius = ps.rect.width / 4;
+            cv::Scalar piece_color = ps.white ? cv::Scalar(255, 255, 255) : cv::Scalar(0, 0, 0);
+            cv::circle(img, center, radius, piece_color, -1);
+            cv::circle(img, center, radius, cv::Scalar(128, 128, 128), 2);
         }
-    } catch (...) {
-        std::cout << "Error creating expanded board image" << std::endl;
-        return;
     }
+}
 
-    _add_side_labels(expanded_board_img);
-    _draw_valid_moves();
-
-    // Draw cursors for both players
-    if (kp1) {
-        int r = last_cursor1.first, c = last_cursor1.second;
-        int y1 = r * (board_size_px / 8);
-        int x1 = c * (board_size_px / 8) + side_panel_width;
-        int y2 = y1 + (board_size_px / 8) - 1;
-        int x2 = x1 + (board_size_px / 8) - 1;
-        cv::rectangle(expanded_board_img, cv::Point(x1, y1), cv::Point(x2, y2), cv::Scalar(0, 255, 0), 2);
-    }
-    if (kp2) {
-        int r = last_cursor2.first, c = last_cursor2.second;
-        int y1 = r * (board_size_px / 8);
-        int x1 = c * (board_size_px / 8) + side_panel_width;
-        int y2 = y1 + (board_size_px / 8) - 1;
-        int x2 = x1 + (board_size_px / 8) - 1;
-        cv::rectangle(expanded_board_img, cv::Point(x1, y1), cv::Point(x2, y2), cv::Scalar(255, 0, 0), 2);
-    }
+void Game::_paint_overlay(cv::Mat &img, const cv::Rect &region) {
+    cv::Point o = region.tl();
+    auto mark_cell = [&](std::pair<int, int> cell, const cv::Scalar &color, int thickness) {
+        cv::Rect r = _cell_rect(cell);
+        cv::rectangle(img, r.tl() - o, r.br() - cv::Point(1, 1) - o, color, thickness);
+    };
+    // ציור כלים נבחרים
+    if (selected_piece1.first != -1) mark_cell(selected_piece1, cv::Scalar(0, 255, 255), 4); // צהוב
+    if (selected_piece2.first != -1) mark_cell(selected_piece2, cv::Scalar(255, 255, 0), 4); // ציאן
+    // ציור מצביעים
+    mark_cell(last_cursor1, cv::Scalar(0, 255, 0), 3);
+    mark_cell(last_cursor2, cv::Scalar(255, 0, 0), 3);
 }
 
-void Game::_show() {
-    if (expanded_board_img.empty()) {
-        std::cout << "ERROR: Board image is empty!" << std::endl;
-        return;
-    }
-    
-    try {
-        cv::imshow("Chess Game", expanded_board_img);
-        cv::moveWindow("Chess Game", 100, 100);
-        
-        int key = cv::waitKeyEx(30);
-        if (key == 27) {
-            exit(0);
-        }
-    } catch (const cv::Exception& e) {
-        std::cout << "OpenCV error in _show: " << e.what() << std::endl;
-    } catch (...) {
-        std::cout << "Unknown error in _show" << std::endl;
+// The sprite state the loop shows for a piece, from when it last moved
+Game::PieceAnim Game::_anim_of(PieceHandle h, int64_t now_ms) const {
+    if (h >= piece_moved_at_ms.size() || piece_moved_at_ms[h] == NOT_MOVED) return PieceAnim::Idle;
+    int64_t elapsed = now_ms - piece_moved_at_ms[h];
+    if (elapsed < 1000) return PieceAnim::Move;
+    return elapsed < 3000 ? PieceAnim::LongRest : PieceAnim::Idle; // חזרה ל-idle
+}
+
+std::string_view Game::_anim_name(PieceAnim a) {
+    switch (a) {
+        case PieceAnim::Move: return "move";
+        case PieceAnim::LongRest: return "long_rest";
+        default: return "idle";
     }
 }
 
-void Game::_resolve_collisions() {
-    _update_cell2piece_map();
-    _check_pawn_promotion();
-    int pieces_before = pieces.size();
-    for (auto &entry : pos) {
-        auto &plist = entry.second;
-        if (plist.size() < 2)
-            continue;
-        // Advanced collision logic: knight/moving piece priority
-        std::vector<std::shared_ptr<Piece>> knights_moving, other_pieces, moving_pieces, stationary_pieces;
-        for (auto &p : plist) {
-            if ((p->id.substr(0, 2) == "NW" || p->id.substr(0, 2) == "NB") && p->state && p->state->name == "move")
-                knights_moving.push_back(p);
-            else
-                other_pieces.push_back(p);
-        }
-        std::shared_ptr<Piece> winner;
-        if (!knights_moving.empty()) {
-            auto knight = knights_moving[0];
-            if (knight->state && knight->state->physics) {
-                auto dest = knight->state->physics->_end_cell;
-                auto curr = knight->current_cell();
-                if (curr != std::make_pair(dest[0], dest[1]))
-                    continue;
-            }
-            winner = knight;
-        } else {
-            for (auto &p : plist) {
-                if (p->state && p->state->name != "idle")
-                    moving_pieces.push_back(p);
-                else
-                    stationary_pieces.push_back(p);
-            }
-            if (!moving_pieces.empty()) {
-                winner = *std::max_element(moving_pieces.begin(), moving_pieces.end(), [](const std::shared_ptr<Piece>& a, const std::shared_ptr<Piece>& b) {
-                    return a->state->physics->get_start_ms() < b->state->physics->get_start_ms();
-                });
-            } else {
-                winner = *std::max_element(plist.begin(), plist.end(), [](const std::shared_ptr<Piece>& a, const std::shared_ptr<Piece>& b) {
-                    return a->state->physics->get_start_ms() < b->state->physics->get_start_ms();
-                });
+void Game::_start_move_anim(PieceHandle h) {
+    if (h >= piece_moved_at_ms.size()) piece_moved_at_ms.resize(h + 1, NOT_MOVED);
+    piece_moved_at_ms[h] = game_time_ms();
+}
+
+// Works out which rectangles changed since the last frame and re-composites
+// only those: a piece's cell when it moved or its sprite frame changed, a
+// cursor/selection's old and new cell, a side panel when its text changed.
+void Game::_draw() {
+    int64_t now_ms = game_time_ms();
+    // חישוב מספר התמונה (מתחלף כל 200ms)
+    int frame = static_cast<int>(now_ms / 200);
+
+    if (_painted_pieces.size() < piece_store.size()) _painted_pieces.resize(piece_store.size());
+    for (PieceHandle h = 0; h < _painted_pieces.size(); ++h) {
+        PaintedPiece ps;
+        if (h < piece_store.size() && piece_store.valid[h]) {
+            // שימוש ישיר במיקום הפיזיקלי במקום current_cell()
+            int row = static_cast<int>(piece_store.row[h]);
+            int col = static_cast<int>(piece_store.col[h]);
+            if (row >= 0 && row < 8 && col >= 0 && col < 8) {
+                const Piece *p = piece_store.piece[h];
+                // Frames come pre-scaled from the atlas - no file I/O while rendering
+                const Img *sprite = sprite_atlas ? sprite_atlas->frame(std::string_view(p->id).substr(0, 2), _anim_name(_anim_of(h, now_ms)), frame) : nullptr;
+                // _paint_pieces falls back to a circle
+                if (sprite_atlas && !sprite) faults.record(Subsystem::Draw, Fault::NoFrame);
+                ps = {true, piece_store.color[h] == PieceColor::White, _cell_rect({row, col}), sprite};
             }
         }
-        for (auto &p : plist) {
-            if (p == winner) continue;
-            if (p->state && p->state->can_be_captured()) {
-                if (p->id.substr(0, 2) == "KW") {
-                    game_log_white.add("Captured: " + p->id);
-                    score_black.add(1);
-                } else if (p->id.substr(0, 2) == "KB") {
-                    game_log_black.add("Captured: " + p->id);
-                    score_white.add(1);
-                } else if (p->id[1] == 'W') {
-                    game_log_white.add("Captured: " + p->id);
-                    score_black.add(1);
-                } else if (p->id[1] == 'B') {
-                    game_log_black.add("Captured: " + p->id);
-                    score_white.add(1);
-                }
-                if (sound) sound->play("../../sounds/Boom_sound.wav");
-                auto it = std::find(pieces.begin(), pieces.end(), p);
-                if (it != pieces.end()) pieces.erase(it);
-            }
+        // Captured pieces (כלים שנאכלו) leave their last cell to repaint
+        PaintedPiece &prev = _painted_pieces[h];
+        if (prev.shown != ps.shown || prev.rect != ps.rect || prev.sprite != ps.sprite) {
+            if (prev.shown) compositor.invalidate(Compositor::PIECES, prev.rect);
+            if (ps.shown) compositor.invalidate(Compositor::PIECES, ps.rect);
         }
-        plist.clear();
-        plist.push_back(winner);
+        prev = ps;
+    }
+
+    if (score_black.get_score() != _painted_scores.first) compositor.invalidate(Compositor::BACKGROUND, _panel_rect(false));
+    if (score_white.get_score() != _painted_scores.second) compositor.invalidate(Compositor::BACKGROUND, _panel_rect(true));
+    _painted_scores = {score_black.get_score(), score_white.get_score()};
+
+    // Frames are 3-4px thick and straddle the cell border
+    std::array<std::pair<int, int>, 4> overlay{last_cursor1, last_cursor2, selected_piece1, selected_piece2};
+    for (size_t i = 0; i < overlay.size(); ++i) {
+        if (overlay[i] == _painted_overlay[i]) continue;
+        for (auto cell : {_painted_overlay[i], overlay[i]}) {
+            if (cell.first == -1) continue;
+            cv::Rect r = _cell_rect(cell);
+            compositor.invalidate(Compositor::OVERLAY, cv::Rect(r.x - 3, r.y - 3, r.width + 6, r.height + 6));
+        }
+    }
+    _painted_overlay = overlay;
+
+    compositor.compose();
+    expanded_board_img = compositor.frame;
+}
+
+// One log line per subsystem that had new faults since the last call, so
+// they show up while the game runs and not only in the end-of-run summary.
+void Game::_log_new_faults() {
+  for (size_t s = 0; s < _faults_logged.size(); ++s) {
+    auto sub = static_cast<Subsystem>(s);
+    uint64_t n = faults.count(sub);
+    if (n == _faults_logged[s]) continue;
+    KFC_WARN(Game, subsystem_name(sub) << ": " << n - _faults_logged[s] << " new fault(s), last "
+                                       << fault_name(faults.last(sub)));
+    _faults_logged[s] = n;
+  }
+}
+
+// The occupant of a cell is taken by a piece that came into it later
+// (CellTimeline only reports it when the occupant's state can be captured).
+// Pieces of one side share a cell without taking each other.
+void Game::_resolve_encounter(const Encounter &e) {
+    if (e.occupant >= piece_store.size() || !piece_store.piece[e.occupant]) {
+        faults.record(Subsystem::Collide, Fault::StalePiece);
+        return;
     }
-    int pieces_after = pieces.size();
-    if (pieces_before != pieces_after) {
+    if (e.attacker < piece_store.size() && piece_store.piece[e.attacker] &&
+        piece_store.color[e.attacker] == piece_store.color[e.occupant])
+        return;
+    const Piece *loser = piece_store.piece[e.occupant];
+    if (loser->piece_color == PieceColor::White) {
+        game_log_white.add("Captured: " + loser->id);
+        score_black.add(1);
+    } else if (loser->piece_color == PieceColor::Black) {
+        game_log_black.add("Captured: " + loser->id);
+        score_white.add(1);
     }
+    _play_sound("Boom_sound.wav");
+    _remove_piece(e.occupant);
+}
+
+// Rules for the piece's type as it is now (a promoted pawn gets the queen's),
+// from its current state or idle. State::moves keeps what the piece was built with.
+std::shared_ptr<const Moves> Game::_rules_of(const Piece &p) const {
+    if (!p.state) return nullptr;
+    auto &registry = MovesRegistry::instance();
+    auto rules = registry.find(p.piece_type, p.piece_color, p.state->name);
+    return rules ? rules : registry.find(p.piece_type, p.piece_color, "idle");
+}
+
+std::vector<std::pair<int, int>> Game::get_valid_moves(const std::string &piece_id) {
+    std::vector<std::pair<int, int>> result;
+    auto it = piece_by_id.find(piece_id);
+    const std::shared_ptr<Piece> *p = it != piece_by_id.end() ? pieces.get(it->second) : nullptr;
+    if (!p || !(*p)->state || !(*p)->state->physics)
+        return result;
+    auto rules = _rules_of(**p);
+    if (!rules)
+        return result;
+    Bitboard dst = rules->legal_destinations((*p)->current_cell(), piece_store.occupancy,
+                                             (*p)->state->physics->is_need_clear_path(), (*p)->piece_color);
+    while (dst) result.push_back(cell_of(pop_lsb(dst)));
+    return result;
 }
 
 bool Game::_validate(const std::vector<std::shared_ptr<Piece>> &pieces_) const {
     bool has_white_king = false, has_black_king = false;
-    std::map<std::pair<int, int>, std::string> seen_cells;
+    std::map<std::pair<int, int>, PieceColor> seen_cells;
     for (const auto &p : pieces_) {
         auto cell = p->current_cell();
-        std::string piece_color(1, p->id[1]);
-        if (seen_cells.count(cell)) {
-            if (seen_cells[cell] == piece_color)
-                return false;
-        } else {
-            seen_cells[cell] = piece_color;
+        auto seen = seen_cells.emplace(cell, p->piece_color);
+        if (!seen.second && seen.first->second == p->piece_color)
+            return false;
+        if (p->piece_type == PieceType::King) {
+            if (p->piece_color == PieceColor::White) has_white_king = true;
+            else if (p->piece_color == PieceColor::Black) has_black_king = true;
         }
-        if (p->id.substr(0, 2) == "KW")
-            has_white_king = true;
-        else if (p->id.substr(0, 2) == "KB")
-            has_black_king = true;
     }
     return has_white_king && has_black_king;
 }
 
 bool Game::_is_win() const {
-    // בדיקה אם יש שני מלכים
-    bool has_white_king = false;
-    bool has_black_king = false;
-    
-    for (const auto &p : pieces) {
-        if (!p) continue;
-        if (p->id.substr(0, 2) == "KW") has_white_king = true;
-        if (p->id.substr(0, 2) == "KB") has_black_king = true;
-    }
-    
-    return !has_white_king || !has_black_king; // משחק מסתיים אם אין אחד מהמלכים
+    // משחק מסתיים אם אין אחד מהמלכים
+    return material_of(PieceColor::White, PieceType::King) == 0 || material_of(PieceColor::Black, PieceType::King) == 0;
 }
 
 void Game::_announce_win() {
     if (!sound) sound = std::make_unique<Sound>();
-    sound->play("../../sounds/applause.wav");
+    _play_sound("applause.wav");
     
     // בדיקה מי ניצח לפי אילו מלכים נשארו
-    bool has_white_king = false;
-    bool has_black_king = false;
-    
-    for (const auto &p : pieces) {
-        if (!p) continue;
-        if (p->id.substr(0, 2) == "KW") has_white_king = true;
-        if (p->id.substr(0, 2) == "KB") has_black_king = true;
-    }
-    
-    bool black_win = has_black_king && !has_white_king;
+    bool black_win = material_of(PieceColor::Black, PieceType::King) > 0 && material_of(PieceColor::White, PieceType::King) == 0;
     std::string win_text = black_win ? "Black wins!" : "White wins!";
     
     if (black_win) {
@@ -238,8 +287,8 @@ void Game::_announce_win() {
     }
     
     // הצגת תמונת ניצחון רק על חלק הלוח
-    std::string img_path = black_win ? "../../pic/black_win.png" : "../../pic/white_win.png";
-    cv::Mat victory_img = cv::imread(img_path);
+    std::string img_path = black_win ? "black_win.png" : "white_win.png";
+    cv::Mat victory_img = _load_picture(img_path);
     if (!victory_img.empty() && !expanded_board_img.empty()) {
         // שינוי גודל התמונה לגודל הלוח בלבד
         cv::resize(victory_img, victory_img, cv::Size(board_size_px, board_size_px));
@@ -248,23 +297,48 @@ void Game::_announce_win() {
         cv::imshow("Chess Game", expanded_board_img);
         cv::waitKey(5000); // הצגה ל-5 שניות
     } else {
-        std::cout << "Could not load victory image: " << img_path << std::endl;
+        KFC_WARN(Render, "Could not load victory image: " << img_path);
     }
     
-    std::cout << win_text << std::endl;
+    KFC_INFO(Game, win_text);
+}
+
+void Game::_play_sound(const std::string &name) {
+    if (!sound) return;
+    if (asset_pack) {
+        auto [data, size] = asset_pack->blob("sounds/" + name);
+        if (data) {
+            sound->play_memory(data, size);
+            return;
+        }
+    }
+    sound->play("../../sounds/" + name);
+}
+
+cv::Mat Game::_load_picture(const std::string &name) const {
+    if (asset_pack) {
+        Img img = asset_pack->image("pic/" + name);
+        if (!img.img.empty()) return img.img.clone(); // the pack mapping is read-only
+    }
+    return cv::imread("../../pic/" + name);
 }
 #include "Game.hpp"
 
 
-Game::Game(const std::vector<std::shared_ptr<Piece>> &pieces_, const Board &board_)
-    : pieces(pieces_), board(board_), _time_factor(1), board_size_px(768),
+Game::Game(const std::vector<std::shared_ptr<Piece>> &pieces_, const Board &board_,
+           std::shared_ptr<Clock> clock_)
+    : board(board_),
+      clock(clock_ ? std::move(clock_) : std::make_shared<RealTimeClock>()), board_size_px(768),
       side_panel_width(300),
-      expanded_width(board_size_px + 2 * side_panel_width) {
+      expanded_width(board_size_px + 2 * side_panel_width),
+      compositor(expanded_width, board_size_px) {
   if (!_validate(pieces_))
     throw InvalidBoard();
-  START_NS = std::chrono::steady_clock::now().time_since_epoch().count();
-  for (const auto &p : pieces)
-    piece_by_id[p->id] = p;
+  for (const auto &p : pieces_) {
+    piece_by_id[p->id] = pieces.insert(p);
+    _count_material(*p, +1);
+  }
+  _rebuild_piece_store();
   sound = std::make_unique<Sound>();
   // Initialize keyboard processors and producers (stub)
   kp1 = std::make_unique<KeyboardProcessor>(8, 8, std::map<std::string, std::string>{{"up","up"},{"down","down"},{"left","left"},{"right","right"}});
@@ -273,13 +347,12 @@ Game::Game(const std::vector<std::shared_ptr<Piece>> &pieces_, const Board &boar
   kb_prod_2 = std::make_unique<KeyboardProducer>(kp2.get(), &user_input_queue, 2);
   last_cursor1 = kp1->get_cursor();
   last_cursor2 = kp2->get_cursor();
+  compositor.set_painter(Compositor::BACKGROUND, [this](cv::Mat &img, const cv::Rect &r) { _paint_background(img, r); });
+  compositor.set_painter(Compositor::PIECES, [this](cv::Mat &img, const cv::Rect &r) { _paint_pieces(img, r); });
+  compositor.set_painter(Compositor::OVERLAY, [this](cv::Mat &img, const cv::Rect &r) { _paint_overlay(img, r); });
 }
 
-int64_t Game::game_time_ms() const {
-  int64_t now_ns =
-      std::chrono::steady_clock::now().time_since_epoch().count();
-  return _time_factor * (now_ns - START_NS) / 1000000;
-}
+int64_t Game::game_time_ms() const { return clock->now_ms(); }
 
 Board Game::clone_board() const { return board.clone(); }
 
@@ -289,583 +362,454 @@ void Game::start_user_input_thread() {
   if (kb_prod_2) kb_prod_2->start();
 }
 
-void Game::_update_cell2piece_map() {
-  pos.clear();
-  for (const auto &p : pieces) {
-      if (!p || !p->state || !p->state->physics) continue;
-      
-      // בדיקת תקינות פוינטר physics
-      void* physics_ptr = p->state->physics.get();
-      uintptr_t ptr_val = reinterpret_cast<uintptr_t>(physics_ptr);
-      if (ptr_val == 0xDDDDDDDDDDDDDDDD || ptr_val == 0 || ptr_val < 0x1000) {
-          continue; // דילוג על כלים פגומים
-      }
-      
-      try {
-          auto cell = p->current_cell();
-          pos[cell].push_back(p);
-      } catch (...) {
-          // שגיאה - מדלגים
-      }
+// Handles are slots in `pieces`: the store, move batch, scheduler and cell
+// timeline are built once here and then follow each piece individually
+void Game::_rebuild_piece_store() {
+  piece_store.assign(pieces);
+  move_batch.clear();
+  scheduler.clear();
+  cell_timeline.clear();
+  for (PieceHandle h = 0; h < piece_store.size(); ++h) _track(h);
+}
+
+// A captured piece leaves every per-piece structure in O(1)-ish work; other
+// pieces keep their slots. Its key goes stale, so queued commands for it drop.
+void Game::_remove_piece(PieceHandle h) {
+  SlotKey key = pieces.key_of(h);
+  const std::shared_ptr<Piece> *p = pieces.get(key);
+  if (!p) return;
+  move_batch.remove(h);
+  scheduler.cancel(h);
+  cell_timeline.release(h);
+  piece_store.detach(h);
+  if (h < piece_moved_at_ms.size()) piece_moved_at_ms[h] = NOT_MOVED;
+  auto it = piece_by_id.find((*p)->id);
+  if (it != piece_by_id.end() && it->second == key) piece_by_id.erase(it);
+  _count_material(**p, -1);
+  pieces.erase(key);
+}
+
+// Promotion: the type and the id's code change, the slot does not
+void Game::_promote_piece(PieceHandle h, PieceType to) {
+  SlotKey key = pieces.key_of(h);
+  const std::shared_ptr<Piece> *p = pieces.get(key);
+  if (!p) return;
+  auto it = piece_by_id.find((*p)->id);
+  if (it != piece_by_id.end() && it->second == key) piece_by_id.erase(it);
+  _count_material(**p, -1);
+  (*p)->set_type(to);
+  _count_material(**p, +1);
+  piece_by_id[(*p)->id] = key;
+}
+
+void Game::_count_material(const Piece &p, int delta) {
+  if (p.piece_type == PieceType::Count || p.piece_color == PieceColor::Count) return;
+  auto &n = material[static_cast<size_t>(p.piece_color)][static_cast<size_t>(p.piece_type)];
+  n = static_cast<uint16_t>(n + delta);
+}
+
+// Registers piece h's current state with the batch (if it travels), the
+// scheduler (if it ends at a known time) and the cell timeline (the cells it
+// holds until then and after). Called whenever its state changes.
+void Game::_track(PieceHandle h) {
+  const Piece *p = h < piece_store.size() ? piece_store.piece[h] : nullptr;
+  if (!p || !p->state || !p->state->physics) {
+    move_batch.remove(h);
+    scheduler.cancel(h);
+    cell_timeline.release(h);
+    return;
+  }
+  const BasePhysics &ph = *p->state->physics;
+  auto due = ph.deadline_ms();
+  int64_t until = due ? *due : CellTimeline::FOREVER;
+  std::pair<int, int> end{ph._end_cell[0], ph._end_cell[1]};
+  std::vector<CellSpan> spans;
+  auto vel = ph.velocity();
+  if (vel.first != 0.0f || vel.second != 0.0f) {
+    float speed = std::hypot(vel.first, vel.second);
+    move_batch.add(h, {ph._start_cell[0], ph._start_cell[1]}, end, speed, ph._start_ms);
+    CellTimeline::trace_line({ph._start_cell[0], ph._start_cell[1]}, end, speed, ph._start_ms, until,
+                             ph.can_be_captured(), spans);
+    // Pieces that need no clear path (knights) fly over everything but their destination
+    if (!ph.is_need_clear_path() && spans.size() > 1) spans.erase(spans.begin(), spans.end() - 1);
+  } else {
+    move_batch.remove(h);
+    auto cell = p->current_cell();
+    spans.push_back({static_cast<int8_t>(cell.first), static_cast<int8_t>(cell.second), ph._start_ms, until,
+                     ph.can_be_captured()});
+  }
+  if (due) {
+    scheduler.schedule(h, *due);
+    // After "done" the piece stays at its end cell in the next state
+    EventId done = event_id(EventKind::Done);
+    const State *next = done < p->state->transitions.size() ? p->state->transitions[done] : nullptr;
+    bool capturable = next && next->physics ? next->physics->can_be_captured() : ph.can_be_captured();
+    spans.push_back({static_cast<int8_t>(end.first), static_cast<int8_t>(end.second), *due, CellTimeline::FOREVER,
+                     capturable});
+  } else {
+    scheduler.cancel(h);
+  }
+  cell_timeline.reserve(h, spans);
+}
+
+// Fires every state deadline and capture up to now in time order, each
+// stamped with its own time so chained states (move -> rest -> idle) keep
+// exact timing and the outcome does not depend on when frames happen to
+// sample, then moves the pieces still travelling. Idle and resting pieces
+// cost nothing. On a tie the capture goes first: a piece rounds into its
+// destination cell before its travel time is over.
+void Game::_advance_to(int64_t now_ms) {
+  for (;;) {
+    int64_t capture_ms = cell_timeline.next_ms();
+    if (capture_ms <= now_ms && capture_ms <= scheduler.next_due()) {
+      Encounter hit;
+      cell_timeline.pop(hit);
+      _resolve_encounter(hit);
+      continue;
+    }
+    EventScheduler::Entry e;
+    if (!scheduler.pop_due(now_ms, e)) break;
+    Piece *p = piece_store.piece[e.piece];
+    if (!p) {
+      faults.record(Subsystem::Update, Fault::StalePiece);
+      continue;
+    }
+    if (!p->state || !p->state->physics) {
+      faults.record(Subsystem::Update, p->state ? Fault::NoPhysics : Fault::NoState);
+      continue;
+    }
+    BasePhysics &ph = *p->state->physics;
+    std::pair<int, int> cell{ph._end_cell[0], ph._end_cell[1]};
+    move_batch.remove(e.piece);
+    ph.stop_at(cell);
+    const State *before = p->state;
+    Fault fault = Fault::None;
+    p->on_command(TypedCommand::done(static_cast<int>(e.due_ms), cell, pieces.key_of(e.piece)), piece_store.occupancy,
+                  &fault);
+    faults.record(Subsystem::Update, fault);
+    // No "done" transition: the deadline is spent, as update() would keep returning it
+    if (p->state != before) _track(e.piece);
+  }
+  if (!move_batch.empty()) {
+    move_batch.integrate(static_cast<int32_t>(now_ms), piece_store.row.data(), piece_store.col.data());
+    piece_store.relocate(move_batch.piece);
   }
 }
 
 void Game::_run_game_loop(int num_iterations, bool is_with_graphics) {
   int it_counter = 0;
-  std::cout << "Starting chess game..." << std::endl;
+  KFC_INFO(Game, "Starting chess game...");
   // אתחול מצביעים - שחקן 1 על כלים שחורים, שחקן 2 על כלים לבנים
   last_cursor1 = {0, 0}; // שחקן 1 - כלים שחורים
   last_cursor2 = {7, 0}; // שחקן 2 - כלים לבנים
   
-  // משתנים לעקוב אחרי כלים נבחרים
-  std::pair<int,int> selected_piece1 = {-1, -1};
-  std::pair<int,int> selected_piece2 = {-1, -1};
+  selected_piece1 = {-1, -1};
+  selected_piece2 = {-1, -1};
   
   // דגלים למנוע לחיצות כפולות
   static bool space_pressed = false;
-  static bool enter_pressed = false;
-  
-  // משתנים לאנימציה
-  struct MovingPiece {
-    std::shared_ptr<Piece> piece;
-    std::pair<float,float> start_pos;
-    std::pair<float,float> end_pos;
-    int start_time;
-    int duration = 300; // 0.3 שנייה
-  };
-  std::vector<MovingPiece> moving_pieces;
   
-  // מעקב אחרי מצבי כלים לאנימציה
-  std::map<std::string, std::string> piece_states; // piece_id -> state_name
-  std::map<std::string, int> piece_state_start_time; // piece_id -> start_time
-  
-  // פונקציה לבדיקת חוקיות התנועה
+  // פונקציה לבדיקת חוקיות התנועה - לפי החוקים שנטענו פעם אחת ברישום.
+  // Stricter than the old offset-only check against idle/moves.txt: the rules
+  // of the piece's current state apply in full, so a "capture" offset needs an
+  // enemy on the target, a "non_capture" offset an empty target, and sliding
+  // pieces (need_clear_path) cannot jump. Manual moves and on_command agree.
   auto is_valid_move = [&](std::shared_ptr<Piece> piece, std::pair<int,int> from, std::pair<int,int> to) -> bool {
     if (!piece || !piece->state) return false;
-    
-    // חישוב ההפרש
-    int dr = to.first - from.first;
-    int dc = to.second - from.second;
-    
-    // קריאת קובץ moves.txt
-    std::string piece_type = piece->id.substr(0, 2);
-    std::string moves_file = "../../pieces/" + piece_type + "/states/idle/moves.txt";
-    
-    std::ifstream file(moves_file);
-    if (!file.is_open()) {
-      std::cout << "Cannot open moves file: " << moves_file << " for piece " << piece->id << std::endl;
-      // אם אין קובץ moves - נתיר כל תנועה (לעת)
+    // Never onto a piece of the same side, rules or not
+    if (on_board(to.first, to.second) && piece_store.occupancy.is_friendly(square_of(to), piece->piece_color))
+      return false;
+    auto rules = _rules_of(*piece);
+    if (!rules) {
+      // אם אין חוקי תנועה - נתיר כל תנועה (לעת)
       return true;
     }
+    bool need_clear_path = piece->state->physics ? piece->state->physics->is_need_clear_path() : true;
+    return rules->is_valid(from, to, piece_store.occupancy, need_clear_path, piece->piece_color);
+  };
+  while (!_is_win() && (num_iterations <= 0 || it_counter < num_iterations)) {
+    frame_scheduler.begin_frame();
+    // ללא עדכון כלים - רק אנימציות חזותיות
+    
+    TypedCommand cmd;
+    while (user_input_queue.pop(cmd)) {
+      _process_input(cmd);
+    }
+    _advance_to(game_time_ms());
+    _log_new_faults();
     
-    std::string line;
-    while (std::getline(file, line)) {
-      if (line.empty()) continue;
+    if (is_with_graphics) {
+      // קריאת מקלדת בלי לחכות - הזמן שנשאר לפריים נישן ב-end_frame
+      int key = cv::waitKeyEx(1);
+      if (key == 27) exit(0);
       
-      // טיפול בשני פורמטים: "dr,dc:type" או "dr,dc"
-      size_t colon_pos = line.find(':');
-      std::string move_part;
+      // ללא debug מקשים
       
-      if (colon_pos != std::string::npos) {
-        // פורמט עם סוג: "dr,dc:type"
-        move_part = line.substr(0, colon_pos);
-      } else {
-        // פורמט פשוט: "dr,dc"
-        move_part = line;
+      // שליטה במצביעים - WASD לשחקן 1 (ירוק - כלים שחורים)
+      if ((key == 119 || key == 87) && last_cursor1.first > 0) {
+        last_cursor1.first--;
       }
-      
-      size_t comma_pos = move_part.find(',');
-      if (comma_pos == std::string::npos) continue;
-      
-      try {
-        int file_dr = std::stoi(move_part.substr(0, comma_pos));
-        int file_dc = std::stoi(move_part.substr(comma_pos + 1));
-        
-        if (file_dr == dr && file_dc == dc) {
-          return true;
-        }
-      } catch (...) {
-        // שגיאה בפירוק - מדלגים
-        continue;
+      if ((key == 115 || key == 83) && last_cursor1.first < 7) {
+        last_cursor1.first++;
+      }
+      if ((key == 97 || key == 65) && last_cursor1.second > 0) {
+        last_cursor1.second--;
+      }
+      if ((key == 100 || key == 68) && last_cursor1.second < 7) {
+        last_cursor1.second++;
       }
-    }
-    
-    return false;
-  };
-  try {
-    while (!_is_win() && (num_iterations <= 0 || it_counter < num_iterations)) {
-      // ללא עדכון כלים - רק אנימציות חזותיות
       
-      while (!user_input_queue.empty()) {
-        Command cmd = user_input_queue.front();
-        user_input_queue.pop();
-        _process_input(cmd);
+      // חיצים לשחקן 2 (אדום - כלים לבנים)
+      if (key == 2490368 && last_cursor2.first > 0) { // חץ למעלה
+        last_cursor2.first--;
+      }
+      if (key == 2621440 && last_cursor2.first < 7) { // חץ למטה
+        last_cursor2.first++;
+      }
+      if (key == 2424832 && last_cursor2.second > 0) { // חץ שמאלה
+        last_cursor2.second--;
+      }
+      if (key == 2555904 && last_cursor2.second < 7) { // חץ ימינה
+        last_cursor2.second++;
       }
       
-      if (is_with_graphics) {
-        try {
-          expanded_board_img = cv::Mat::zeros(board_size_px, expanded_width, CV_8UC3);
-          expanded_board_img(cv::Rect(0, 0, side_panel_width, board_size_px)) = cv::Scalar(50, 150, 50);
-          expanded_board_img(cv::Rect(side_panel_width + board_size_px, 0, side_panel_width, board_size_px)) = cv::Scalar(150, 50, 50);
-          cv::Mat chess_board = cv::Mat::zeros(board_size_px, board_size_px, CV_8UC3);
-          int square_size = board_size_px / 8;
-          for (int r = 0; r < 8; r++) {
-            for (int c = 0; c < 8; c++) {
-              cv::Scalar color = ((r + c) % 2 == 0) ? cv::Scalar(240, 217, 181) : cv::Scalar(181, 136, 99);
-              cv::rectangle(chess_board, cv::Point(c * square_size, r * square_size), 
-                           cv::Point((c + 1) * square_size, (r + 1) * square_size), color, -1);
+      // בחירת כלים
+      if (key == 32 && !space_pressed) { // רווח - שחקן 1
+        space_pressed = true;
+        if (selected_piece1.first == -1) {
+          // חיפוש איזה כלי במיקום הזה ובדיקת מצבו
+          std::string piece_at_pos = "None";
+          bool can_select = false;
+          PieceHandle at_cursor = piece_store.piece_at(last_cursor1);
+          if (at_cursor != NO_PIECE) {
+            const auto &p = pieces[at_cursor];
+            piece_at_pos = p->id;
+            // בדיקה אם הכלי במצב שניתן לבחור בו
+            PieceAnim anim = _anim_of(at_cursor, game_time_ms());
+            if (anim != PieceAnim::Idle) {
+              KFC_WARN(Input, "Cannot select " << p->id << " - piece is busy (" << _anim_name(anim) << ")");
+              can_select = false;
+            } else {
+              can_select = true;
             }
           }
-          chess_board.copyTo(expanded_board_img(cv::Rect(side_panel_width, 0, board_size_px, board_size_px)));
           
-          // ציור הכלים על הלוח
-          for (const auto &p : pieces) {
-            if (!p || !p->state || !p->state->physics) continue;
-            try {
-              // שימוש ישיר במיקום הפיזיקלי במקום current_cell()
-              int row, col;
+          if (can_select) {
+            selected_piece1 = last_cursor1;
+            KFC_DEBUG(Input, "Player 1 selected piece at (" << last_cursor1.first << "," << last_cursor1.second << ") - piece: " << piece_at_pos);
+          }
+        } else {
+          KFC_DEBUG(Input, "Player 1 moving piece from (" << selected_piece1.first << "," << selected_piece1.second << ") to (" << last_cursor1.first << "," << last_cursor1.second << ")");
+          // חיפוש הכלי ובדיקת חוקיות
+          PieceHandle selected = piece_store.piece_at(selected_piece1);
+          if (selected != NO_PIECE) {
+            auto p = pieces[selected]; // a copy: captures erase from `pieces`
+            // בדיקת חוקיות התנועה
+            if (is_valid_move(p, selected_piece1, {last_cursor1.first, last_cursor1.second})) {
+              // דילוג על on_command - עדכון ישיר של המיקום
+              
+              // עדכון מלא של מיקום הכלי
               if (p->state && p->state->physics) {
-                row = static_cast<int>(p->state->physics->_curr_pos_m[0]);
-                col = static_cast<int>(p->state->physics->_curr_pos_m[1]);
-                
-                // Debug - הדפסה רק לכלי שזז
-                if (p->id == "PB_1,0" || p->id == "PB_1,1") {
-                  std::cout << "Drawing " << p->id << " at physics pos (" << row << "," << col << ")" << std::endl;
-                }
+                p->state->physics->_curr_pos_m[0] = static_cast<float>(last_cursor1.first);
+                p->state->physics->_curr_pos_m[1] = static_cast<float>(last_cursor1.second);
+                p->state->physics->_start_cell[0] = last_cursor1.first;
+                p->state->physics->_start_cell[1] = last_cursor1.second;
+                p->state->physics->_end_cell[0] = last_cursor1.first;
+                p->state->physics->_end_cell[1] = last_cursor1.second;
+                p->state->physics->_start_ms = static_cast<int>(game_time_ms());
               } else {
-                auto cell = p->current_cell();
-                row = cell.first;
-                col = cell.second;
+                KFC_ERROR(Input, "No physics state available!");
               }
               
-              if (row >= 0 && row < 8 && col >= 0 && col < 8) {
-                int x = side_panel_width + col * square_size;
-                int y = row * square_size;
-                
-                // בניית שם קובץ התמונה לפי מצב הכלי
-                std::string piece_type = p->id.substr(0, 2);
-                std::string state_name = "idle";
-                
-                // בדיקת מצב הכלי מהמעקב שלנו
-                if (piece_states.count(p->id)) {
-                  int elapsed = game_time_ms() - piece_state_start_time[p->id];
-                  if (piece_states[p->id] == "move" && elapsed < 1000) {
-                    state_name = "move";
-                  } else if (piece_states[p->id] == "move" && elapsed >= 1000 && elapsed < 3000) {
-                    state_name = "long_rest";
-                  } else if (elapsed >= 3000) {
-                    piece_states[p->id] = "idle"; // חזרה ל-idle
-                  }
-                }
-                
-                // חישוב מספר התמונה (מתחלף בין 1-5)
-                int frame = ((game_time_ms() / 200) % 5) + 1; // החלפה כל 200ms
-                
-                std::string piece_file = "../../pieces/" + piece_type + "/states/" + state_name + "/sprites/" + std::to_string(frame) + ".png";
-                cv::Mat piece_img = cv::imread(piece_file, cv::IMREAD_UNCHANGED);
-                
-                // Debug - בדיקה ראשונה בלבד
-                static bool first_check = true;
-                if (first_check) {
-                  std::cout << "Trying to load: " << piece_file << std::endl;
-                  std::cout << "Image loaded: " << (!piece_img.empty() ? "YES" : "NO") << std::endl;
-                  first_check = false;
-                }
-                
-                if (!piece_img.empty()) {
-                  // שינוי גודל התמונה לגודל המשבצת
-                  cv::Mat resized_piece;
-                  cv::resize(piece_img, resized_piece, cv::Size(square_size, square_size));
+              // עדכון מצב הכלי לאנימציה
+              _start_move_anim(p->handle);
+              
+              // בדיקת קידום חייל למלכה
+              if (p->piece_type == PieceType::Pawn && p->piece_color == PieceColor::Black && last_cursor1.first == 7) {
+                _promote_piece(p->handle, PieceType::Queen);
+                KFC_INFO(Input, "Pawn promoted to Queen: " << p->id);
+              } else if (p->piece_type == PieceType::Pawn && p->piece_color == PieceColor::White && last_cursor1.first == 0) {
+                _promote_piece(p->handle, PieceType::Queen);
+                KFC_INFO(Input, "Pawn promoted to Queen: " << p->id);
+              }
+              // physics and id were changed directly - refresh the store row and timeline
+              p->publish();
+              _track(p->handle);
+              
+              // השמעת קול צעדים
+              _play_sound("foot_step.wav");
+              
+              // עדכון לוג (ללא ניקוד על מהלך רגיל)
+              std::string move_str = p->id + ": (" + std::to_string(selected_piece1.first) + "," + std::to_string(selected_piece1.second) + ") -> (" + std::to_string(last_cursor1.first) + "," + std::to_string(last_cursor1.second) + ")";
+              if (p->piece_color == PieceColor::Black) {
+                game_log_black.add(move_str);
+                _push_moves_log(black_moves_log, move_str);
+              }
+              
+              // בדיקה אם יש כלי יריב במיקום היעד (אכילה)
+              for (PieceHandle h = piece_store.piece_at(last_cursor1); h != NO_PIECE; h = piece_store.next_at(h)) {
+                auto enemy = pieces[h];
+                if (enemy && enemy != p && enemy->piece_color != p->piece_color) {
+                  game_log_black.add("Captured: " + enemy->id);
+                  // השמעת קול אכילה
+                  _play_sound("Boom_sound.wav");
                   
-                  // טיפול בשקיפות (alpha channel)
-                  if (resized_piece.channels() == 4) {
-                    std::vector<cv::Mat> channels;
-                    cv::split(resized_piece, channels);
-                    cv::Mat alpha = channels[3];
-                    cv::Mat bgr;
-                    cv::merge(std::vector<cv::Mat>{channels[0], channels[1], channels[2]}, bgr);
-                    
-                    // העתקת התמונה עם שקיפות
-                    cv::Mat roi = expanded_board_img(cv::Rect(x, y, square_size, square_size));
-                    for (int i = 0; i < bgr.rows; ++i) {
-                      for (int j = 0; j < bgr.cols; ++j) {
-                        if (alpha.at<uchar>(i, j) > 128) {
-                          roi.at<cv::Vec3b>(i, j) = bgr.at<cv::Vec3b>(i, j);
-                        }
-                      }
-                    }
+                  if (enemy->piece_type == PieceType::King && enemy->piece_color == PieceColor::White) {
+                    score_black.add(100); // ניקוד מיוחד לאכילת מלך
+                    game_log_black.add("CHECKMATE! Black wins!");
                   } else {
-                    // העתקה רגילה ללא שקיפות
-                    resized_piece.copyTo(expanded_board_img(cv::Rect(x, y, square_size, square_size)));
+                    score_black.add(10); // ניקוד רגיל לאכילה
                   }
-                } else {
-                  // אם אין תמונה - ציור עיגול פשוט
-                  cv::Scalar piece_color = (p->id[1] == 'W') ? cv::Scalar(255, 255, 255) : cv::Scalar(0, 0, 0);
-                  cv::circle(expanded_board_img, cv::Point(x + square_size/2, y + square_size/2), 
-                            square_size/4, piece_color, -1);
-                  cv::circle(expanded_board_img, cv::Point(x + square_size/2, y + square_size/2), 
-                            square_size/4, cv::Scalar(128, 128, 128), 2);
+                  _remove_piece(h); // הסרת הכלי הנאכל
+                  break;
                 }
               }
-            } catch (...) {
-              // שגיאה בציור כלי - מדלגים
+              KFC_DEBUG(Input, "Valid move - started animation");
+            } else {
+              KFC_INFO(Input, "Invalid move!");
             }
           }
-          
-          // ציור כלים נבחרים
-          if (selected_piece1.first != -1) {
-            int r = selected_piece1.first, c = selected_piece1.second;
-            int y1 = r * square_size;
-            int x1 = c * square_size + side_panel_width;
-            int y2 = y1 + square_size - 1;
-            int x2 = x1 + square_size - 1;
-            cv::rectangle(expanded_board_img, cv::Point(x1, y1), cv::Point(x2, y2), cv::Scalar(0, 255, 255), 4); // צהוב
-          }
-          if (selected_piece2.first != -1) {
-            int r = selected_piece2.first, c = selected_piece2.second;
-            int y1 = r * square_size;
-            int x1 = c * square_size + side_panel_width;
-            int y2 = y1 + square_size - 1;
-            int x2 = x1 + square_size - 1;
-            cv::rectangle(expanded_board_img, cv::Point(x1, y1), cv::Point(x2, y2), cv::Scalar(255, 255, 0), 4); // ציאן
-          }
-          
-          // ציור מצביעים
-          int r1 = last_cursor1.first, c1 = last_cursor1.second;
-          int y1 = r1 * square_size;
-          int x1 = c1 * square_size + side_panel_width;
-          int y2 = y1 + square_size - 1;
-          int x2 = x1 + square_size - 1;
-          cv::rectangle(expanded_board_img, cv::Point(x1, y1), cv::Point(x2, y2), cv::Scalar(0, 255, 0), 3);
-          
-          int r2 = last_cursor2.first, c2 = last_cursor2.second;
-          y1 = r2 * square_size;
-          x1 = c2 * square_size + side_panel_width;
-          y2 = y1 + square_size - 1;
-          x2 = x1 + square_size - 1;
-          cv::rectangle(expanded_board_img, cv::Point(x1, y1), cv::Point(x2, y2), cv::Scalar(255, 0, 0), 3);
-          
-          // ציור ניקוד ומידע שחקנים
-          // צד שמאל - שחקן שחור
-          cv::putText(expanded_board_img, "BLACK PLAYER", cv::Point(10, 30), cv::FONT_HERSHEY_SIMPLEX, 0.7, cv::Scalar(255, 255, 255), 2);
-          cv::putText(expanded_board_img, "Score: " + std::to_string(score_black.get_score()), cv::Point(10, 60), cv::FONT_HERSHEY_SIMPLEX, 0.6, cv::Scalar(0, 255, 0), 2);
-          cv::putText(expanded_board_img, "Controls: WASD + Space", cv::Point(10, 90), cv::FONT_HERSHEY_SIMPLEX, 0.4, cv::Scalar(200, 200, 200), 1);
-          
-          // הצגת לוגים שחורים
-          cv::putText(expanded_board_img, "Recent Moves:", cv::Point(10, 130), cv::FONT_HERSHEY_SIMPLEX, 0.5, cv::Scalar(255, 255, 0), 1);
-          static std::vector<std::string> black_moves_log;
-          // שמירת המהלכים במשתנה סטטי
-          
-          // צד ימין - שחקן לבן
-          int right_x = side_panel_width + board_size_px + 10;
-          cv::putText(expanded_board_img, "WHITE PLAYER", cv::Point(right_x, 30), cv::FONT_HERSHEY_SIMPLEX, 0.7, cv::Scalar(255, 255, 255), 2);
-          cv::putText(expanded_board_img, "Score: " + std::to_string(score_white.get_score()), cv::Point(right_x, 60), cv::FONT_HERSHEY_SIMPLEX, 0.6, cv::Scalar(0, 255, 0), 2);
-          cv::putText(expanded_board_img, "Controls: -> <- ... + Enter", cv::Point(right_x, 90), cv::FONT_HERSHEY_SIMPLEX, 0.4, cv::Scalar(200, 200, 200), 1);
-          
-          // הצגת לוגים לבנים
-          cv::putText(expanded_board_img, "Recent Moves:", cv::Point(right_x, 130), cv::FONT_HERSHEY_SIMPLEX, 0.5, cv::Scalar(255, 255, 0), 1);
-          static std::vector<std::string> white_moves_log;
-          
-          // ציור לוגים שחורים
-          for (size_t i = 0; i < black_moves_log.size() && i < 8; ++i) {
-            std::string display_move = black_moves_log[i];
-            if (display_move.length() > 25) display_move = display_move.substr(0, 22) + "...";
-            cv::putText(expanded_board_img, display_move, cv::Point(10, 160 + i * 20), 
-                       cv::FONT_HERSHEY_SIMPLEX, 0.35, cv::Scalar(200, 200, 200), 1);
-          }
-          
-          // ציור לוגים לבנים
-          for (size_t i = 0; i < white_moves_log.size() && i < 8; ++i) {
-            std::string display_move = white_moves_log[i];
-            if (display_move.length() > 25) display_move = display_move.substr(0, 22) + "...";
-            cv::putText(expanded_board_img, display_move, cv::Point(right_x, 160 + i * 20), 
-                       cv::FONT_HERSHEY_SIMPLEX, 0.35, cv::Scalar(200, 200, 200), 1);
-          }
-          
-          cv::imshow("Chess Game", expanded_board_img);
-          int key = cv::waitKeyEx(30);
-          if (key == 27) exit(0);
-          
-          // ללא debug מקשים
-          
-          // שליטה במצביעים - WASD לשחקן 1 (ירוק - כלים שחורים)
-          if ((key == 119 || key == 87) && last_cursor1.first > 0) {
-            last_cursor1.first--;
-          }
-          if ((key == 115 || key == 83) && last_cursor1.first < 7) {
-            last_cursor1.first++;
-          }
-          if ((key == 97 || key == 65) && last_cursor1.second > 0) {
-            last_cursor1.second--;
-          }
-          if ((key == 100 || key == 68) && last_cursor1.second < 7) {
-            last_cursor1.second++;
+          selected_piece1 = {-1, -1}; // ביטול בחירה
+        }
+      } else if (key != 32) {
+        space_pressed = false; // איפוס דגל כשמקש אחר נלחץ
+      }
+      if (key == 13) { // אנטר - שחקן 2
+        if (selected_piece2.first == -1) {
+          // חיפוש איזה כלי במיקום הזה ובדיקת מצבו
+          std::string piece_at_pos = "None";
+          bool can_select = false;
+          PieceHandle at_cursor = piece_store.piece_at(last_cursor2);
+          if (at_cursor != NO_PIECE) {
+            const auto &p = pieces[at_cursor];
+            piece_at_pos = p->id;
+            // בדיקה אם הכלי במצב שניתן לבחור בו
+            PieceAnim anim = _anim_of(at_cursor, game_time_ms());
+            if (anim != PieceAnim::Idle) {
+              KFC_WARN(Input, "Cannot select " << p->id << " - piece is busy (" << _anim_name(anim) << ")");
+              can_select = false;
+            } else {
+              can_select = true;
+            }
           }
           
-          // חיצים לשחקן 2 (אדום - כלים לבנים)
-          if (key == 2490368 && last_cursor2.first > 0) { // חץ למעלה
-            last_cursor2.first--;
-          }
-          if (key == 2621440 && last_cursor2.first < 7) { // חץ למטה
-            last_cursor2.first++;
-          }
-          if (key == 2424832 && last_cursor2.second > 0) { // חץ שמאלה
-            last_cursor2.second--;
-          }
-          if (key == 2555904 && last_cursor2.second < 7) { // חץ ימינה
-            last_cursor2.second++;
+          if (can_select) {
+            selected_piece2 = last_cursor2;
+            KFC_DEBUG(Input, "Player 2 selected piece at (" << last_cursor2.first << "," << last_cursor2.second << ") - piece: " << piece_at_pos);
           }
-          
-          // בחירת כלים
-          if (key == 32 && !space_pressed) { // רווח - שחקן 1
-            space_pressed = true;
-            if (selected_piece1.first == -1) {
-              // חיפוש איזה כלי במיקום הזה ובדיקת מצבו
-              std::string piece_at_pos = "None";
-              bool can_select = false;
-              for (const auto &p : pieces) {
-                if (p && p->current_cell() == last_cursor1) {
-                  piece_at_pos = p->id;
-                  // בדיקה אם הכלי במצב שניתן לבחור בו
-                  std::string current_state = "idle";
-                  if (piece_states.count(p->id)) {
-                    int elapsed = game_time_ms() - piece_state_start_time[p->id];
-                    if (piece_states[p->id] == "move" && elapsed < 1000) {
-                      current_state = "move";
-                    } else if (piece_states[p->id] == "move" && elapsed >= 1000 && elapsed < 3000) {
-                      current_state = "long_rest";
-                    }
-                  }
-                  
-                  if (current_state == "move" || current_state == "long_rest") {
-                    std::cout << "[WARN] Cannot select " << p->id << " - piece is busy (" << current_state << ")" << std::endl;
-                    can_select = false;
-                  } else {
-                    can_select = true;
-                  }
-                  break;
-                }
+        } else {
+          KFC_DEBUG(Input, "Player 2 moving piece from (" << selected_piece2.first << "," << selected_piece2.second << ") to (" << last_cursor2.first << "," << last_cursor2.second << ")");
+          // חיפוש הכלי ובדיקת חוקיות
+          PieceHandle selected = piece_store.piece_at(selected_piece2);
+          if (selected != NO_PIECE) {
+            auto p = pieces[selected]; // a copy: captures erase from `pieces`
+            // בדיקת חוקיות התנועה
+            if (is_valid_move(p, selected_piece2, {last_cursor2.first, last_cursor2.second})) {
+              // דילוג על on_command - עדכון ישיר של המיקום
+              
+              // עדכון מלא של מיקום הכלי
+              if (p->state && p->state->physics) {
+                p->state->physics->_curr_pos_m[0] = static_cast<float>(last_cursor2.first);
+                p->state->physics->_curr_pos_m[1] = static_cast<float>(last_cursor2.second);
+                p->state->physics->_start_cell[0] = last_cursor2.first;
+                p->state->physics->_start_cell[1] = last_cursor2.second;
+                p->state->physics->_end_cell[0] = last_cursor2.first;
+                p->state->physics->_end_cell[1] = last_cursor2.second;
+                p->state->physics->_start_ms = static_cast<int>(game_time_ms());
               }
               
-              if (can_select) {
-                selected_piece1 = last_cursor1;
-                std::cout << "Player 1 selected piece at (" << last_cursor1.first << "," << last_cursor1.second << ") - piece: " << piece_at_pos << std::endl;
+              // עדכון מצב הכלי לאנימציה
+              _start_move_anim(p->handle);
+              
+              // בדיקת קידום חייל למלכה
+              if (p->piece_type == PieceType::Pawn && p->piece_color == PieceColor::White && last_cursor2.first == 0) {
+                _promote_piece(p->handle, PieceType::Queen);
+                KFC_INFO(Input, "Pawn promoted to Queen: " << p->id);
+              } else if (p->piece_type == PieceType::Pawn && p->piece_color == PieceColor::Black && last_cursor2.first == 7) {
+                _promote_piece(p->handle, PieceType::Queen);
+                KFC_INFO(Input, "Pawn promoted to Queen: " << p->id);
               }
-            } else {
-              std::cout << "Player 1 moving piece from (" << selected_piece1.first << "," << selected_piece1.second << ") to (" << last_cursor1.first << "," << last_cursor1.second << ")" << std::endl;
-              // חיפוש הכלי ובדיקת חוקיות
-              std::cout << "Looking for piece at (" << selected_piece1.first << "," << selected_piece1.second << ")" << std::endl;
-              for (auto &p : pieces) {
-                if (p) {
-                  auto current_pos = p->current_cell();
-                  std::cout << "Found piece " << p->id << " at (" << current_pos.first << "," << current_pos.second << ")" << std::endl;
-                }
-                if (p && p->current_cell() == selected_piece1) {
-                  std::cout << "MATCH! Found piece " << p->id << " for movement" << std::endl;
-                  // בדיקת חוקיות התנועה
-                  std::cout << "Checking if move is valid..." << std::endl;
-                  bool move_valid = is_valid_move(p, selected_piece1, {last_cursor1.first, last_cursor1.second});
-                  std::cout << "Move valid: " << (move_valid ? "YES" : "NO") << std::endl;
-                  if (move_valid) {
-                    std::cout << "ENTERING MOVE EXECUTION" << std::endl;
-                    // דילוג על on_command - עדכון ישיר של המיקום
-                    std::cout << "Skipping on_command, updating position directly..." << std::endl;
-                    
-                    // עדכון מלא של מיקום הכלי
-                    std::cout << "About to update piece position..." << std::endl;
-                    if (p->state && p->state->physics) {
-                      std::cout << "Physics exists, updating position from (" << p->state->physics->_curr_pos_m[0] << "," << p->state->physics->_curr_pos_m[1] << ") to (" << last_cursor1.first << "," << last_cursor1.second << ")" << std::endl;
-                      p->state->physics->_curr_pos_m[0] = static_cast<float>(last_cursor1.first);
-                      p->state->physics->_curr_pos_m[1] = static_cast<float>(last_cursor1.second);
-                      p->state->physics->_start_cell[0] = last_cursor1.first;
-                      p->state->physics->_start_cell[1] = last_cursor1.second;
-                      p->state->physics->_end_cell[0] = last_cursor1.first;
-                      p->state->physics->_end_cell[1] = last_cursor1.second;
-                      std::cout << "Position updated! New physics pos: (" << p->state->physics->_curr_pos_m[0] << "," << p->state->physics->_curr_pos_m[1] << ")" << std::endl;
-                    } else {
-                      std::cout << "ERROR: No physics state available!" << std::endl;
-                    }
-                    
-                    // עדכון מצב הכלי לאנימציה
-                    piece_states[p->id] = "move";
-                    piece_state_start_time[p->id] = game_time_ms();
-                    
-                    // בדיקת קידום חייל למלכה
-                    if (p->id.substr(0, 2) == "PB" && last_cursor1.first == 7) {
-                      p->id = "QB" + p->id.substr(2);
-                      std::cout << "Pawn promoted to Queen: " << p->id << std::endl;
-                    } else if (p->id.substr(0, 2) == "PW" && last_cursor1.first == 0) {
-                      p->id = "QW" + p->id.substr(2);
-                      std::cout << "Pawn promoted to Queen: " << p->id << std::endl;
-                    }
-                    
-                    // השמעת קול צעדים
-                    if (sound) sound->play("../../sounds/foot_step.wav");
-                    
-                    // עדכון לוג (ללא ניקוד על מהלך רגיל)
-                    std::string move_str = p->id + ": (" + std::to_string(selected_piece1.first) + "," + std::to_string(selected_piece1.second) + ") -> (" + std::to_string(last_cursor1.first) + "," + std::to_string(last_cursor1.second) + ")";
-                    if (p->id[1] == 'B') {
-                      game_log_black.add(move_str);
-                      black_moves_log.push_back(move_str);
-                      if (black_moves_log.size() > 8) black_moves_log.erase(black_moves_log.begin());
-                    }
-                    
-                    // בדיקה אם יש כלי יריב במיקום היעד (אכילה)
-                    for (auto it = pieces.begin(); it != pieces.end(); ++it) {
-                      auto &enemy = *it;
-                      if (enemy && enemy != p && enemy->current_cell() == std::make_pair(last_cursor1.first, last_cursor1.second) && enemy->id[1] != p->id[1]) {
-                        game_log_black.add("Captured: " + enemy->id);
-                        // השמעת קול אכילה
-                        if (sound) sound->play("../../sounds/Boom_sound.wav");
-                        
-                        if (enemy->id.substr(0, 2) == "KW") {
-                          score_black.add(100); // ניקוד מיוחד לאכילת מלך
-                          game_log_black.add("CHECKMATE! Black wins!");
-                        } else {
-                          score_black.add(10); // ניקוד רגיל לאכילה
-                        }
-                        pieces.erase(it); // הסרת הכלי הנאכל
-                        break;
-                      }
-                    }
-                    std::cout << "Valid move - started animation" << std::endl;
-                  } else {
-                    std::cout << "Invalid move!" << std::endl;
-                  }
-                  break;
-                }
+              // physics and id were changed directly - refresh the store row and timeline
+              p->publish();
+              _track(p->handle);
+              
+              // השמעת קול צעדים
+              _play_sound("foot_step.wav");
+              
+              // עדכון לוג (ללא ניקוד על מהלך רגיל)
+              std::string move_str = p->id + ": (" + std::to_string(selected_piece2.first) + "," + std::to_string(selected_piece2.second) + ") -> (" + std::to_string(last_cursor2.first) + "," + std::to_string(last_cursor2.second) + ")";
+              if (p->piece_color == PieceColor::White) {
+                game_log_white.add(move_str);
+                _push_moves_log(white_moves_log, move_str);
               }
-              selected_piece1 = {-1, -1}; // ביטול בחירה
-            }
-          } else if (key != 32) {
-            space_pressed = false; // איפוס דגל כשמקש אחר נלחץ
-          }
-          if (key == 13) { // אנטר - שחקן 2
-            if (selected_piece2.first == -1) {
-              // חיפוש איזה כלי במיקום הזה ובדיקת מצבו
-              std::string piece_at_pos = "None";
-              bool can_select = false;
-              for (const auto &p : pieces) {
-                if (p && p->current_cell() == last_cursor2) {
-                  piece_at_pos = p->id;
-                  // בדיקה אם הכלי במצב שניתן לבחור בו
-                  std::string current_state = "idle";
-                  if (piece_states.count(p->id)) {
-                    int elapsed = game_time_ms() - piece_state_start_time[p->id];
-                    if (piece_states[p->id] == "move" && elapsed < 1000) {
-                      current_state = "move";
-                    } else if (piece_states[p->id] == "move" && elapsed >= 1000 && elapsed < 3000) {
-                      current_state = "long_rest";
-                    }
-                  }
+              
+              // בדיקה אם יש כלי יריב במיקום היעד (אכילה)
+              for (PieceHandle h = piece_store.piece_at(last_cursor2); h != NO_PIECE; h = piece_store.next_at(h)) {
+                auto enemy = pieces[h];
+                if (enemy && enemy != p && enemy->piece_color != p->piece_color) {
+                  game_log_white.add("Captured: " + enemy->id);
+                  // השמעת קול אכילה
+                  _play_sound("Boom_sound.wav");
                   
-                  if (current_state == "move" || current_state == "long_rest") {
-                    std::cout << "[WARN] Cannot select " << p->id << " - piece is busy (" << current_state << ")" << std::endl;
-                    can_select = false;
+                  if (enemy->piece_type == PieceType::King && enemy->piece_color == PieceColor::Black) {
+                    score_white.add(100); // ניקוד מיוחד לאכילת מלך
+                    game_log_white.add("CHECKMATE! White wins!");
                   } else {
-                    can_select = true;
+                    score_white.add(10); // ניקוד רגיל לאכילה
                   }
+                  _remove_piece(h); // הסרת הכלי הנאכל
                   break;
                 }
               }
-              
-              if (can_select) {
-                selected_piece2 = last_cursor2;
-                std::cout << "Player 2 selected piece at (" << last_cursor2.first << "," << last_cursor2.second << ") - piece: " << piece_at_pos << std::endl;
-              }
+              KFC_DEBUG(Input, "Valid move - started animation");
             } else {
-              std::cout << "Player 2 moving piece from (" << selected_piece2.first << "," << selected_piece2.second << ") to (" << last_cursor2.first << "," << last_cursor2.second << ")" << std::endl;
-              // חיפוש הכלי ובדיקת חוקיות
-              for (auto &p : pieces) {
-                if (p && p->current_cell() == selected_piece2) {
-                  // בדיקת חוקיות התנועה
-                  if (is_valid_move(p, selected_piece2, {last_cursor2.first, last_cursor2.second})) {
-                    // דילוג על on_command - עדכון ישיר של המיקום
-                    std::cout << "Player 2: Skipping on_command, updating position directly..." << std::endl;
-                    
-                    // עדכון מלא של מיקום הכלי
-                    if (p->state && p->state->physics) {
-                      p->state->physics->_curr_pos_m[0] = static_cast<float>(last_cursor2.first);
-                      p->state->physics->_curr_pos_m[1] = static_cast<float>(last_cursor2.second);
-                      p->state->physics->_start_cell[0] = last_cursor2.first;
-                      p->state->physics->_start_cell[1] = last_cursor2.second;
-                      p->state->physics->_end_cell[0] = last_cursor2.first;
-                      p->state->physics->_end_cell[1] = last_cursor2.second;
-                      std::cout << "Piece moved to (" << last_cursor2.first << "," << last_cursor2.second << ")" << std::endl;
-                    }
-                    
-                    // עדכון מצב הכלי לאנימציה
-                    piece_states[p->id] = "move";
-                    piece_state_start_time[p->id] = game_time_ms();
-                    
-                    // בדיקת קידום חייל למלכה
-                    if (p->id.substr(0, 2) == "PW" && last_cursor2.first == 0) {
-                      p->id = "QW" + p->id.substr(2);
-                      std::cout << "Pawn promoted to Queen: " << p->id << std::endl;
-                    } else if (p->id.substr(0, 2) == "PB" && last_cursor2.first == 7) {
-                      p->id = "QB" + p->id.substr(2);
-                      std::cout << "Pawn promoted to Queen: " << p->id << std::endl;
-                    }
-                    
-                    // השמעת קול צעדים
-                    if (sound) sound->play("../../sounds/foot_step.wav");
-                    
-                    // עדכון לוג (ללא ניקוד על מהלך רגיל)
-                    std::string move_str = p->id + ": (" + std::to_string(selected_piece2.first) + "," + std::to_string(selected_piece2.second) + ") -> (" + std::to_string(last_cursor2.first) + "," + std::to_string(last_cursor2.second) + ")";
-                    if (p->id[1] == 'W') {
-                      game_log_white.add(move_str);
-                      white_moves_log.push_back(move_str);
-                      if (white_moves_log.size() > 8) white_moves_log.erase(white_moves_log.begin());
-                    }
-                    
-                    // בדיקה אם יש כלי יריב במיקום היעד (אכילה)
-                    for (auto it = pieces.begin(); it != pieces.end(); ++it) {
-                      auto &enemy = *it;
-                      if (enemy && enemy != p && enemy->current_cell() == std::make_pair(last_cursor2.first, last_cursor2.second) && enemy->id[1] != p->id[1]) {
-                        game_log_white.add("Captured: " + enemy->id);
-                        // השמעת קול אכילה
-                        if (sound) sound->play("../../sounds/Boom_sound.wav");
-                        
-                        if (enemy->id.substr(0, 2) == "KB") {
-                          score_white.add(100); // ניקוד מיוחד לאכילת מלך
-                          game_log_white.add("CHECKMATE! White wins!");
-                        } else {
-                          score_white.add(10); // ניקוד רגיל לאכילה
-                        }
-                        pieces.erase(it); // הסרת הכלי הנאכל
-                        break;
-                      }
-                    }
-                    std::cout << "Valid move - started animation" << std::endl;
-                  } else {
-                    std::cout << "Invalid move!" << std::endl;
-                  }
-                  break;
-                }
-              }
-              selected_piece2 = {-1, -1}; // ביטול בחירה
+              KFC_INFO(Input, "Invalid move!");
             }
           }
-        } catch (...) {
-          // שגיאה בגרפיקה - ממשיכים
+          selected_piece2 = {-1, -1}; // ביטול בחירה
         }
       }
-      
-      ++it_counter;
-      std::this_thread::sleep_for(std::chrono::milliseconds(16)); // ~60 FPS
-      if (num_iterations > 0 && num_iterations <= it_counter) {
-          return;
-      }
+
+      // Render after handling input so a key press shows up in this frame
+      _draw();
+      // החלון שומר את התמונה הקודמת - שולחים רק כשמשהו השתנה
+      if (render_stats().dirty_pixels > 0) cv::imshow("Chess Game", expanded_board_img);
+    }
+    
+    ++it_counter;
+    if (clock->is_realtime()) {
+      frame_scheduler.end_frame();
+    } else if (!is_with_graphics && user_input_queue.empty() && !scheduler.empty()) {
+      // Headless: nothing happens before the next deadline, go straight there
+      clock->sleep_for_ms(std::max<int64_t>(1, next_event_ms() - game_time_ms()));
+    } else {
+      clock->sleep_for_ms(static_cast<int64_t>(frame_scheduler.period_ms()));
     }
-  } catch (const std::exception& e) {
-    std::cout << "Exception in game loop: " << e.what() << std::endl;
-  } catch (...) {
-    std::cout << "Unknown exception in game loop" << std::endl;
   }
   if (_is_win()) {
-    std::cout << "Game ended - win condition met after " << it_counter << " iterations" << std::endl;
+    KFC_INFO(Game, "Game ended - win condition met after " << it_counter << " iterations");
   } else {
-    std::cout << "Game loop ended after " << it_counter << " iterations" << std::endl;
+    KFC_INFO(Game, "Game loop ended after " << it_counter << " iterations");
+  }
+  const auto &fs = frame_scheduler.stats();
+  if (fs.frames > 0) {
+    KFC_INFO(Game, "Frames: target " << frame_scheduler.target_fps() << " FPS, work avg " << fs.avg_work_ms()
+                   << " ms / max " << fs.max_work_ms << " ms, " << fs.missed_deadlines << " missed deadlines");
+  }
+  const auto &rs = render_stats();
+  if (rs.frames > 0) {
+    KFC_INFO(Game, "Render: " << rs.frames << " frames, " << rs.idle_frames << " idle, "
+                   << rs.total_dirty_pixels / rs.frames << " dirty px/frame on average");
+  }
+  if (faults.total() > 0) {
+    std::string line = "Faults:";
+    for (size_t s = 0; s < static_cast<size_t>(Subsystem::Count); ++s) {
+      auto sub = static_cast<Subsystem>(s);
+      if (faults.count(sub) == 0) continue;
+      line += std::string(" ") + subsystem_name(sub) + " " + std::to_string(faults.count(sub)) + " (last " +
+              fault_name(faults.last(sub)) + ")";
+    }
+    KFC_WARN(Game, line);
   }
 }
 
@@ -873,7 +817,7 @@ void Game::run(int num_iterations, bool is_with_graphics) {
   try {
     start_user_input_thread();
     for (auto &p : pieces)
-      p->reset(START_NS);
+      p->reset(static_cast<int>(game_time_ms()));
     _run_game_loop(num_iterations, is_with_graphics);
     if (_is_win()) {
       _announce_win();
@@ -881,52 +825,53 @@ void Game::run(int num_iterations, bool is_with_graphics) {
     if (kb_prod_1) kb_prod_1->stop();
     if (kb_prod_2) kb_prod_2->stop();
   } catch (const std::exception &ex) {
-    std::cerr << "[EXCEPTION] " << ex.what() << std::endl;
+    KFC_ERROR(Game, "Game run aborted: " << ex.what());
   } catch (...) {
-    std::cerr << "[EXCEPTION] unknown exception" << std::endl;
+    KFC_ERROR(Game, "Game run aborted: unknown exception");
   }
+  // Callers print after run(); let the log writer catch up first, errors included
+  Logger::instance().flush();
 }
 
 
 
 // Helper to convert Command to string for publishing
-static std::string command_to_string(const Command& cmd) {
-    std::string s = "type:" + cmd.type + ",piece_id:" + cmd.piece_id + ",params:";
-    for (const auto& param : cmd.params) {
-        // Try to print as pair<int,int> or fallback to typeid
-        try {
-            auto cell = std::any_cast<std::pair<int, int>>(param);
-            s += "(" + std::to_string(cell.first) + "," + std::to_string(cell.second) + ") ";
-        } catch (...) {
-            s += std::string("[type:") + param.type().name() + "] ";
-        }
-    }
+static std::string command_to_string(const TypedCommand& cmd, const std::string& piece_id) {
+    std::string s = std::string("type:") + event_name(cmd.kind) + ",piece_id:" + piece_id + ",params:";
+    if (cmd.cell_count >= 1) s += "(" + std::to_string(cmd.src.row) + "," + std::to_string(cmd.src.col) + ") ";
+    if (cmd.cell_count >= 2) s += "(" + std::to_string(cmd.dst.row) + "," + std::to_string(cmd.dst.col) + ") ";
     return s;
 }
 
-void Game::_process_input(const Command &cmd) {
+bool Game::enqueue(const Command &cmd) {
     auto it = piece_by_id.find(cmd.piece_id);
-    if (it == piece_by_id.end())
+    if (it == piece_by_id.end() || !pieces.contains(it->second)) return false;
+    return user_input_queue.push(to_typed(cmd, it->second));
+}
+
+void Game::_process_input(const TypedCommand &cmd) {
+    // Stale key: the piece was captured after the command was queued
+    const std::shared_ptr<Piece> *slot = pieces.get(cmd.piece);
+    if (!slot || !*slot) {
+        faults.record(Subsystem::Input, Fault::StalePiece);
         return;
-    auto &mover = it->second;
-    if (cmd.type == "move" && cmd.params.size() >= 2) {
-        auto piece_current_cell = mover->current_cell();
-        auto command_src_cell = std::any_cast<std::pair<int, int>>(cmd.params[0]);
-        if (piece_current_cell != command_src_cell) {
-            // Update the command to use the actual piece location
-            // (not implemented: would require mutability)
-        }
     }
-    bool flag = mover->on_command(cmd, pos);
-    // Update logs, score, and publish move
-    if (flag && cmd.type == "move") {
-        std::string cmd_str = command_to_string(cmd);
-        if (cmd.piece_id[1] == 'W') {
-            game_log_white.add("Move: " + cmd.piece_id);
+    const auto &mover = *slot;
+    const State *before = mover->state;
+    Fault fault = Fault::None;
+    bool flag = mover->on_command(cmd, piece_store.occupancy, &fault);
+    faults.record(Subsystem::Input, fault);
+    if (mover->state != before) _track(cmd.piece.slot);
+    // Update logs, score, and publish move (strings only for moves that happened)
+    if (flag && cmd.kind == EventKind::Move) {
+        const std::string &piece_id = mover->id;
+        std::string cmd_str = command_to_string(cmd, piece_id);
+        if (mover->piece_color == PieceColor::White) {
+            game_log_white.add("Move: " + piece_id);
             score_white.add(1);
             publisher.publish("moves", "white", cmd_str);
-        } else if (cmd.piece_id[1] == 'B') {
-            game_log_black.add("Move: " + cmd.piece_id);
+        } else if (mover->piece_color == PieceColor::Black) {
+            game_log_black.add("Move: " + piece_id);
             score_black.add(1);
             publisher.publish("moves", "black", cmd_str);
         }
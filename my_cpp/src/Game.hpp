@@ -2,12 +2,27 @@
 #include "../../my_cpp_pub/GameLog.hpp"
 #include "../../my_cpp_pub/Publisher.hpp"
 #include "../../my_cpp_pub/Score.hpp"
+#include "Bitboard.hpp"
 #include "Board.hpp"
+#include "CellTimeline.hpp"
+#include "Clock.hpp"
 #include "Command.hpp"
+#include "CommandQueue.hpp"
+#include "Compositor.hpp"
+#include "EventScheduler.hpp"
+#include "Faults.hpp"
+#include "FrameScheduler.hpp"
 #include "KeyboardInput.hpp"
+#include "Log.hpp"
+#include "MoveBatch.hpp"
+#include "MovesRegistry.hpp"
 #include "Piece.hpp"
+#include "PieceStore.hpp"
+#include "SlotMap.hpp"
 #include "Sound.hpp"
+#include "SpriteAtlas.hpp"
 #include <algorithm>
+#include <array>
 #include <chrono>
 #include <iostream>
 #include <map>
@@ -18,6 +33,8 @@
 #include <thread>
 #include <vector>
 
+class AssetPack;
+
 
 class InvalidBoard : public std::exception {
 public:
@@ -29,15 +46,34 @@ public:
 
 class Game {
 public:
-  std::vector<std::shared_ptr<Piece>> pieces;
+  // Live pieces in stable slots; a slot number is the piece's PieceHandle
+  SlotMap<std::shared_ptr<Piece>> pieces;
   Board board;
-  int64_t START_NS;
-  int _time_factor;
-  std::queue<Command> user_input_queue;
-  std::map<std::pair<int, int>, std::vector<std::shared_ptr<Piece>>> pos;
-  std::map<std::string, std::shared_ptr<Piece>> piece_by_id;
+  std::shared_ptr<Clock> clock;
+  FrameScheduler frame_scheduler{60.0}; // set_target_fps() to change the loop rate
+  CommandQueue user_input_queue;
+  // Kept up to date on capture and promotion; resolve with pieces.get()
+  std::map<std::string, SlotKey> piece_by_id;
+  // Live pieces per color and type, counted on insert, capture and
+  // promotion, so _is_win is two array reads
+  std::array<std::array<uint16_t, static_cast<size_t>(PieceType::Count)>, static_cast<size_t>(PieceColor::Count)> material{};
+  // Per-frame fields of `pieces` as arrays, same indices; rebuilt when the
+  // list changes. Also the board index (piece_store.occupancy, piece_at).
+  PieceStore piece_store;
+  // Pieces travelling through a move state; positions land in piece_store
+  MoveBatch move_batch;
+  // When each piece's timed state (move, rest, jump) ends, by piece handle
+  EventScheduler scheduler;
+  // Which piece holds which cell over time, from the pieces' paths; yields
+  // the captures in the order they happen
+  CellTimeline cell_timeline;
+  // Faults of the per-frame paths (input, update, collide, draw), which
+  // report them instead of throwing; readable while the game runs
+  FaultCounters faults;
+  std::array<uint64_t, static_cast<size_t>(Subsystem::Count)> _faults_logged{}; // counts already logged
   std::string selected_id_1, selected_id_2;
   std::pair<int, int> last_cursor1, last_cursor2;
+  std::pair<int, int> selected_piece1{-1, -1}, selected_piece2{-1, -1};
   std::unique_ptr<KeyboardProcessor> kp1, kp2;
   std::unique_ptr<KeyboardProducer> kb_prod_1, kb_prod_2;
   std::unique_ptr<Sound> sound;
@@ -45,8 +81,20 @@ public:
   int side_panel_width;
   int expanded_width;
   cv::Mat expanded_board_img;
+  Compositor compositor;
+  std::shared_ptr<const SpriteAtlas> sprite_atlas;
+  // Set by create_game_from_pack: sounds and pictures come from the pack
+  std::shared_ptr<const AssetPack> asset_pack;
   Board curr_board;
 
+  // מצבי אנימציה של הכלים: a piece moved by the keyboard shows "move" for
+  // 1 s, then "long_rest" until 3 s, then "idle". By PieceHandle.
+  enum class PieceAnim : uint8_t { Idle, Move, LongRest };
+  static constexpr int64_t NOT_MOVED = INT64_MIN;
+  std::vector<int64_t> piece_moved_at_ms; // NOT_MOVED or past the end: idle
+  // ויומן מהלכים לפאנלים
+  std::vector<std::string> black_moves_log, white_moves_log;
+
   // Publisher, Score, GameLog (from my_cpp_pub)
   Publisher publisher;
   Score score_white = Score("white", &publisher);
@@ -54,26 +102,69 @@ public:
   GameLog game_log_white = GameLog("white", &publisher);
   GameLog game_log_black = GameLog("black", &publisher);
 
-  Game(const std::vector<std::shared_ptr<Piece>> &pieces_, const Board &board_);
+  // Without a clock the game runs on wall-clock time (RealTimeClock).
+  Game(const std::vector<std::shared_ptr<Piece>> &pieces_, const Board &board_,
+       std::shared_ptr<Clock> clock_ = nullptr);
 
   int64_t game_time_ms() const;
   Board clone_board() const;
   void start_user_input_thread();
-  void _update_cell2piece_map();
+  void _rebuild_piece_store();
+  void _track(PieceHandle h);
+  void _remove_piece(PieceHandle h);
+  void _promote_piece(PieceHandle h, PieceType to);
+  void _count_material(const Piece &p, int delta);
+  int material_of(PieceColor c, PieceType t) const {
+    return material[static_cast<size_t>(c)][static_cast<size_t>(t)];
+  }
+  void _advance_to(int64_t now_ms);
+  // Game time of the next scheduled state change, EventScheduler::NEVER if none
+  int64_t next_event_ms() const { return scheduler.next_due(); }
   void _run_game_loop(int num_iterations = -1, bool is_with_graphics = true);
   void run(int num_iterations = -1, bool is_with_graphics = true);
   void _draw();
-  void _show();
-  void _add_side_labels(cv::Mat &img);
+  void _log_new_faults();
+  void _add_side_labels(cv::Mat &img, cv::Point origin = cv::Point(0, 0));
+  void _paint_background(cv::Mat &img, const cv::Rect &region);
+  void _paint_pieces(cv::Mat &img, const cv::Rect &region);
+  void _paint_overlay(cv::Mat &img, const cv::Rect &region);
+  cv::Rect _panel_rect(bool white) const;
+  cv::Rect _cell_rect(std::pair<int, int> cell) const;
+  PieceAnim _anim_of(PieceHandle h, int64_t now_ms) const;
+  static std::string_view _anim_name(PieceAnim a);
+  void _start_move_anim(PieceHandle h);
+  void _push_moves_log(std::vector<std::string> &log, const std::string &move);
   void _draw_valid_moves();
   void _check_pawn_promotion();
+  std::shared_ptr<const Moves> _rules_of(const Piece &p) const;
   std::vector<std::pair<int, int>> get_valid_moves(const std::string &piece_id);
 
-  void _resolve_collisions();
-  void _process_input(const Command &cmd);
+  void _resolve_encounter(const Encounter &e);
+  void _process_input(const TypedCommand &cmd);
+  // Old-form commands: resolves piece_id to its handle and queues the typed form
+  bool enqueue(const Command &cmd);
 
   bool _validate(const std::vector<std::shared_ptr<Piece>> &pieces_) const;
   bool _is_win() const;
   void _announce_win();
+  // name relative to sounds/ or pic/; read from asset_pack when there is one
+  void _play_sound(const std::string &name);
+  cv::Mat _load_picture(const std::string &name) const;
+
+  // Dirty-rectangle counters of the last frame and totals since start
+  const Compositor::Stats &render_stats() const { return compositor.stats(); }
+
+private:
+  // What the compositor layers currently show, to detect what to repaint;
+  // by PieceHandle, `shown` false for a slot with nothing drawn
+  struct PaintedPiece {
+    bool shown = false;
+    bool white = false;
+    cv::Rect rect;
+    const Img *sprite = nullptr;
+  };
+  std::vector<PaintedPiece> _painted_pieces;
+  std::pair<int, int> _painted_scores{-1, -1};
+  std::array<std::pair<int, int>, 4> _painted_overlay{};
 };
 
@@ -1,7 +1,10 @@
 #pragma once
+#include "AssetPack.hpp"
 #include "Board.hpp"
 #include "PieceFactory.hpp"
 #include "Game.hpp"
+#include "SpriteAtlas.hpp"
+#include <chrono>
 #include <filesystem>
 #include <fstream>
 #include <sstream>
@@ -11,23 +14,32 @@
 
 static const int CELL_PX = 96;
 
-inline std::shared_ptr<Game> create_game(const std::filesystem::path& pieces_root, std::function<Img(const std::filesystem::path&, std::pair<int, int>, bool)> img_factory) {
+// load_workers: threads decoding sprites at startup (0 = one per hardware thread)
+inline std::shared_ptr<Game> create_game(const std::filesystem::path& pieces_root, std::function<Img(const std::filesystem::path&, std::pair<int, int>, bool)> img_factory,
+                                         std::shared_ptr<Clock> clock = nullptr, size_t load_workers = 0) {
     try {
         auto board_csv = pieces_root / "board.csv";
         if (!std::filesystem::exists(board_csv)) {
-            std::cerr << "[ERROR] File not found: " << board_csv << std::endl;
             throw std::runtime_error("File not found: " + board_csv.string());
         }
         auto board_png = pieces_root / "board.png";
         if (!std::filesystem::exists(board_png)) {
-            std::cerr << "[ERROR] File not found: " << board_png << std::endl;
             throw std::runtime_error("File not found: " + board_png.string());
         }
         auto loader = img_factory;
         Img board_img = loader(board_png, {CELL_PX*8, CELL_PX*8}, false);
         Board board(CELL_PX, CELL_PX, 8, 8, board_img);
+        // Every sprite is decoded once here, in parallel; piece templates share these frames.
+        // The stock ImgFactory goes through the built-in path so decode and resize are timed apart.
+        AssetLoadTimings timings;
+        auto atlas = std::make_shared<SpriteAtlas>();
+        {
+            WorkerPool pool(load_workers);
+            atlas->load(pieces_root, {CELL_PX, CELL_PX}, img_factory.target<ImgFactory>() ? nullptr : img_factory, &pool, &timings);
+        }
+        auto assemble_start = std::chrono::steady_clock::now();
         auto gfx_factory = std::make_shared<GraphicsFactory>(img_factory);
-        auto pf = std::make_shared<PieceFactory>(board, pieces_root, gfx_factory);
+        auto pf = std::make_shared<PieceFactory>(board, pieces_root, gfx_factory, nullptr, atlas);
         std::vector<std::shared_ptr<Piece>> pieces;
         std::ifstream f(board_csv);
         std::string line;
@@ -45,10 +57,59 @@ inline std::shared_ptr<Game> create_game(const std::filesystem::path& pieces_roo
             }
             ++r;
         }
-        std::cout << "[DEBUG] create_game: all pieces created" << std::endl;
-        return std::make_shared<Game>(pieces, board);
+        timings.assemble_ms += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - assemble_start).count();
+        KFC_INFO(Game, "Startup: " << timings.to_string() << ", " << pieces.size() << " pieces");
+        auto game = std::make_shared<Game>(pieces, board, std::move(clock));
+        game->sprite_atlas = atlas;
+        return game;
+    } catch (const std::exception& ex) {
+        KFC_ERROR(Game, "create_game failed: " << ex.what());
+        throw;
+    }
+}
+
+// Starts from a pack built by tools/pack_assets: the file is mapped, and
+// sprites, move tables, transitions and configs are used as stored. No PNG
+// decode, JSON parse or directory walk happens here.
+inline std::shared_ptr<Game> create_game_from_pack(std::shared_ptr<const AssetPack> pack, std::shared_ptr<Clock> clock = nullptr) {
+    try {
+        auto start = std::chrono::steady_clock::now();
+        int cell_px = pack->cell_px();
+        Img board_img = pack->board_image();
+        if (board_img.img.empty()) throw std::runtime_error("Asset pack has no board image");
+        board_img.img = board_img.img.clone(); // pieces are drawn into the board image; the mapping is read-only
+        Board board(cell_px, cell_px, 8, 8, board_img);
+        auto atlas = std::make_shared<SpriteAtlas>();
+        atlas->cell_size = {cell_px, cell_px};
+        auto pf = std::make_shared<PieceFactory>(board, std::filesystem::path(), nullptr, nullptr, atlas);
+        auto& registry = MovesRegistry::instance();
+        for (auto& tpl : pack->templates()) {
+            for (auto& [name, st] : tpl->states) {
+                atlas->add(tpl->type, name, st.frames);
+                if (st.moves) st.moves = registry.adopt(tpl->type, name, st.moves);
+            }
+            pf->add_template(std::move(tpl));
+        }
+        std::vector<std::shared_ptr<Piece>> pieces;
+        auto layout = pack->layout();
+        for (int r = 0; r < static_cast<int>(layout.size()); ++r) {
+            for (int c = 0; c < static_cast<int>(layout[r].size()); ++c) {
+                if (!layout[r][c].empty()) pieces.push_back(pf->create_piece(layout[r][c], {r, c}));
+            }
+        }
+        KFC_INFO(Game, "Startup: " << pieces.size() << " pieces from the asset pack ("
+                       << pack->size_bytes() / 1024 << " KiB) in "
+                       << std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() << " ms");
+        auto game = std::make_shared<Game>(pieces, board, std::move(clock));
+        game->sprite_atlas = atlas;
+        game->asset_pack = pack;
+        return game;
     } catch (const std::exception& ex) {
-        std::cerr << "[EXCEPTION] in create_game: " << ex.what() << std::endl;
+        KFC_ERROR(Game, "create_game_from_pack failed: " << ex.what());
         throw;
     }
 }
+
+inline std::shared_ptr<Game> create_game_from_pack(const std::filesystem::path& pack_path, std::shared_ptr<Clock> clock = nullptr) {
+    return create_game_from_pack(AssetPack::open(pack_path), std::move(clock));
+}
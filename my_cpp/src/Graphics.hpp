@@ -11,7 +11,7 @@
 
 class Graphics {
 public:
-    std::vector<Img> frames;
+    std::shared_ptr<const std::vector<Img>> frames; // shared by every piece of the type
     bool loop;
     float fps;
     int start_ms;
@@ -28,7 +28,15 @@ public:
              bool loop_ = true,
              float fps_ = 6.0f)
         : _img_loader(img_loader), loop(loop_), fps(fps_), start_ms(0), cur_frame(0), frame_duration_ms(1000.0f / fps_) {
-        frames = _load_sprites(sprites_folder, cell_size);
+        frames = std::make_shared<const std::vector<Img>>(_load_sprites(sprites_folder, cell_size));
+    }
+
+    // Frames already decoded elsewhere (SpriteAtlas / PieceTemplate).
+    Graphics(std::shared_ptr<const std::vector<Img>> frames_, bool loop_ = true, float fps_ = 6.0f)
+        : frames(std::move(frames_)), loop(loop_), fps(fps_), start_ms(0), cur_frame(0), frame_duration_ms(1000.0f / fps_) {
+        if (!frames || frames->empty()) {
+            throw std::runtime_error("No frames for animation");
+        }
     }
 
     Graphics copy() const {
@@ -51,24 +59,25 @@ public:
         return frames;
     }
 
-    void reset(const Command& cmd) {
+    void reset(const TypedCommand& cmd) {
         start_ms = cmd.timestamp;
         cur_frame = 0;
     }
+    void reset(const Command& cmd) { reset(to_typed(cmd)); }
 
     void update(int now_ms) {
         int elapsed = now_ms - start_ms;
         int frames_passed = static_cast<int>(elapsed / frame_duration_ms);
         if (loop) {
-            cur_frame = frames_passed % frames.size();
+            cur_frame = frames_passed % frames->size();
         } else {
-            cur_frame = std::min(frames_passed, static_cast<int>(frames.size()) - 1);
+            cur_frame = std::min(frames_passed, static_cast<int>(frames->size()) - 1);
         }
     }
 
-    Img get_img() const {
-        if (frames.empty()) throw std::runtime_error("No frames loaded for animation.");
-        if (cur_frame >= static_cast<int>(frames.size())) throw std::runtime_error("Frame index out of range");
-        return frames[cur_frame];
+    // The current frame, nullptr when there is none to show
+    const Img* get_img() const {
+        if (!frames || cur_frame < 0 || cur_frame >= static_cast<int>(frames->size())) return nullptr;
+        return &(*frames)[cur_frame];
     }
 };
\ No newline at end of file
@@ -11,10 +11,22 @@ Img& Img::read(const std::string& path,
               std::pair<int, int> size,
               bool keep_aspect,
               int interpolation) {
+    decode(path);
+    return resize_to(size, keep_aspect, interpolation, path);
+}
+
+Img& Img::decode(const std::string& path) {
     img = cv::imread(path, cv::IMREAD_UNCHANGED);
     if (img.empty()) {
         throw std::runtime_error("Cannot load image: " + path);
     }
+    return *this;
+}
+
+Img& Img::resize_to(std::pair<int, int> size,
+                    bool keep_aspect,
+                    int interpolation,
+                    const std::string& path) {
     if (size.first > 0 && size.second > 0) {
         int target_w = size.first;
         int target_h = size.second;
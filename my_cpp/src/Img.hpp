@@ -1,4 +1,5 @@
 #pragma once
+#include "Blend.hpp"
 #include <opencv2/opencv.hpp>
 #include <string>
 #include <iostream>
@@ -14,50 +15,40 @@ public:
               bool keep_aspect = false,
               int interpolation = cv::INTER_AREA);
 
+    // The two halves of read(), for loaders that time or schedule them apart.
+    Img& decode(const std::string& path);
+    Img& resize_to(std::pair<int, int> size,
+                   bool keep_aspect = false,
+                   int interpolation = cv::INTER_AREA,
+                   const std::string& path = "");
+
     Img copy() const {
         Img new_img;
         new_img.img = img.clone();
         return new_img;
     }
 
-    void draw_on(Img& other_img, int x, int y) {
+    // False when either image is empty; a sprite that does not fit is skipped
+    bool draw_on(Img& other_img, int x, int y) const {
         if (img.empty() || other_img.img.empty()) {
-            throw std::runtime_error("Both images must be loaded before drawing.");
-        }
-        int src_channels = img.channels();
-        int dst_channels = other_img.img.channels();
-        cv::Mat src = img;
-        if (src_channels != dst_channels) {
-            if (src_channels == 3 && dst_channels == 4) {
-                cv::cvtColor(img, src, cv::COLOR_BGR2BGRA);
-            } else if (src_channels == 4 && dst_channels == 3) {
-                cv::cvtColor(img, src, cv::COLOR_BGRA2BGR);
-            }
+            return false;
         }
-        int h = src.rows, w = src.cols;
+        int h = img.rows, w = img.cols;
         int H = other_img.img.rows, W = other_img.img.cols;
         if (h == 0 || w == 0 || y < 0 || x < 0 || y + h > H || x + w > W) {
-            return;
+            return true;
         }
         cv::Mat roi = other_img.img(cv::Rect(x, y, w, h));
-        if (src.channels() == 4) {
-            std::vector<cv::Mat> bgra;
-            cv::split(src, bgra);
-            cv::Mat mask;
-            bgra[3].convertTo(mask, CV_32F, 1.0 / 255.0);
-            for (int c = 0; c < 3; ++c) {
-                cv::Mat roi_channel, src_channel;
-                std::vector<cv::Mat> roi_channels;
-                cv::split(roi, roi_channels);
-                roi_channels[c].convertTo(roi_channel, CV_32F);
-                bgra[c].convertTo(src_channel, CV_32F);
-                roi_channel = (1.0 - mask).mul(roi_channel) + mask.mul(src_channel);
-                roi_channel.convertTo(roi_channels[c], roi.type());
-                cv::merge(roi_channels, roi);
-            }
+        int src_channels = img.channels();
+        int dst_channels = roi.channels();
+        if (src_channels == 4 && img.depth() == CV_8U && roi.depth() == CV_8U && (dst_channels == 3 || dst_channels == 4)) {
+            blend_bgra_over(img.data, img.step, roi.data, roi.step, dst_channels, w, h);
+        } else if (src_channels == 3 && dst_channels == 4) {
+            cv::cvtColor(img, roi, cv::COLOR_BGR2BGRA);
         } else {
-            src.copyTo(roi);
+            img.copyTo(roi);
         }
+        return true;
     }
 
     void put_text(const std::string& txt, int x, int y, double font_size, cv::Scalar color = cv::Scalar(255,255,255,255), int thickness = 1) {
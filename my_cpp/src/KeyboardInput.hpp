@@ -1,6 +1,6 @@
 
 #pragma once
-#include "Command.hpp"
+#include "CommandQueue.hpp"
 #include <map>
 #include <string>
 #include <vector>
@@ -8,7 +8,6 @@
 #include <thread>
 #include <iostream>
 #include <algorithm>
-#include <queue>
 #include <chrono>
 
 // Forward declaration
@@ -20,10 +19,10 @@ public:
     bool running;
     std::thread th;
     KeyboardProcessor* kp;
-    std::queue<Command>* queue;
+    CommandQueue* queue;
     int player;
 
-    KeyboardProducer(KeyboardProcessor* kp_, std::queue<Command>* q, int player_)
+    KeyboardProducer(KeyboardProcessor* kp_, CommandQueue* q, int player_)
         : running(false), kp(kp_), queue(q), player(player_) {}
 
     void start() {
@@ -0,0 +1,233 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+
+// Leveled, categorized logging that never blocks the caller on I/O.
+//
+//   KFC_DEBUG(Physics, "move " << from << " -> " << to);
+//
+// The message is formatted into a fixed-size record on the caller's stack and
+// pushed into a lock-free ring; a background thread drains the ring to the
+// output stream. A full ring drops the record and counts it. Levels below
+// KFC_LOG_LEVEL are compiled out (arguments are not evaluated); the rest can
+// be filtered at runtime per category with Logger::set_level.
+
+enum class LogLevel : uint8_t { Trace, Debug, Info, Warn, Error, Off };
+enum class LogCategory : uint8_t { Game, Input, State, Physics, Moves, Render, Sound, Count };
+
+// 0 Trace .. 5 Off
+#ifndef KFC_LOG_LEVEL
+#ifdef NDEBUG
+#define KFC_LOG_LEVEL 2
+#else
+#define KFC_LOG_LEVEL 1
+#endif
+#endif
+
+inline const char* log_level_name(LogLevel l) {
+    static constexpr const char* names[] = {"TRACE", "DEBUG", "INFO ", "WARN ", "ERROR", "OFF  "};
+    return names[static_cast<size_t>(l)];
+}
+
+inline const char* log_category_name(LogCategory c) {
+    static constexpr const char* names[] = {"game", "input", "state", "physics", "moves", "render", "sound"};
+    return c < LogCategory::Count ? names[static_cast<size_t>(c)] : "?";
+}
+
+struct LogRecord {
+    static constexpr size_t TEXT = 232;
+    int64_t us;           // since the logger started
+    LogLevel level;
+    LogCategory category;
+    uint16_t length;
+    char text[TEXT];
+};
+
+class Logger {
+public:
+    static constexpr size_t CAPACITY = 1024; // records; power of two
+
+    static Logger& instance() {
+        static Logger logger;
+        return logger;
+    }
+
+    Logger(const Logger&) = delete;
+    Logger& operator=(const Logger&) = delete;
+
+    ~Logger() {
+        _running.store(false, std::memory_order_release);
+        if (_writer.joinable()) _writer.join();
+        _drain();
+        _out->flush();
+    }
+
+    bool enabled(LogCategory c, LogLevel l) const {
+        return l >= _level[static_cast<size_t>(c)].load(std::memory_order_relaxed);
+    }
+    void set_level(LogCategory c, LogLevel l) { _level[static_cast<size_t>(c)].store(l, std::memory_order_relaxed); }
+    void set_level(LogLevel l) {
+        for (auto& x : _level) x.store(l, std::memory_order_relaxed);
+    }
+
+    // Only before anything is logged, or after flush(): the writer thread uses it
+    void set_output(std::ostream& out) { _out = &out; }
+
+    // Never blocks; false when the ring is full and the record was dropped
+    bool push(const LogRecord& r) {
+        size_t pos = _enqueue.load(std::memory_order_relaxed);
+        for (;;) {
+            Cell& cell = _ring[pos % CAPACITY];
+            size_t seq = cell.seq.load(std::memory_order_acquire);
+            auto diff = static_cast<std::ptrdiff_t>(seq) - static_cast<std::ptrdiff_t>(pos);
+            if (diff == 0) {
+                if (_enqueue.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    cell.record = r;
+                    cell.seq.store(pos + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                _dropped.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            } else {
+                pos = _enqueue.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    // Waits until everything pushed so far is written (end of a run, before
+    // printing around the logger). Not for the frame thread.
+    void flush() {
+        size_t target = _enqueue.load(std::memory_order_acquire);
+        while (_dequeue.load(std::memory_order_acquire) < target && _running.load(std::memory_order_acquire)) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        _out->flush();
+    }
+
+    uint64_t dropped() const { return _dropped.load(std::memory_order_relaxed); }
+
+    int64_t now_us() const {
+        return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - _epoch).count();
+    }
+
+private:
+    struct Cell {
+        std::atomic<size_t> seq;
+        LogRecord record;
+    };
+
+    std::array<Cell, CAPACITY> _ring;
+    alignas(64) std::atomic<size_t> _enqueue{0};
+    alignas(64) std::atomic<size_t> _dequeue{0}; // written by the writer thread only
+    std::atomic<uint64_t> _dropped{0};
+    uint64_t _reported = 0; // drops already mentioned in the output
+    std::array<std::atomic<LogLevel>, static_cast<size_t>(LogCategory::Count)> _level;
+    std::ostream* _out = &std::cout;
+    std::chrono::steady_clock::time_point _epoch = std::chrono::steady_clock::now();
+    std::atomic<bool> _running{true};
+    std::thread _writer;
+
+    Logger() {
+        for (size_t i = 0; i < CAPACITY; ++i) _ring[i].seq.store(i, std::memory_order_relaxed);
+        set_level(static_cast<LogLevel>(KFC_LOG_LEVEL));
+        _writer = std::thread([this] {
+            while (_running.load(std::memory_order_acquire)) {
+                if (!_drain()) std::this_thread::sleep_for(std::chrono::milliseconds(2));
+            }
+        });
+    }
+
+    // Writes every record ready in the ring; false when there was none
+    bool _drain() {
+        bool wrote = false;
+        size_t pos = _dequeue.load(std::memory_order_relaxed);
+        for (;;) {
+            Cell& cell = _ring[pos % CAPACITY];
+            if (cell.seq.load(std::memory_order_acquire) != pos + 1) break;
+            const LogRecord& r = cell.record;
+            char head[48];
+            int n = std::snprintf(head, sizeof(head), "[%9.3f] %s %s: ", r.us / 1000.0, log_level_name(r.level),
+                                  log_category_name(r.category));
+            _out->write(head, n);
+            _out->write(r.text, r.length);
+            _out->put('\n');
+            cell.seq.store(pos + CAPACITY, std::memory_order_release);
+            _dequeue.store(++pos, std::memory_order_release);
+            wrote = true;
+        }
+        if (wrote) {
+            uint64_t lost = _dropped.load(std::memory_order_relaxed);
+            if (lost > _reported) *_out << "[log] " << lost - _reported << " records dropped (ring full)\n";
+            _reported = lost;
+            _out->flush();
+        }
+        return wrote;
+    }
+};
+
+// One message being formatted; pushed to the logger when it goes out of
+// scope. Text past LogRecord::TEXT is cut off.
+class LogLine {
+public:
+    LogLine(LogLevel level, LogCategory category) {
+        _r.us = Logger::instance().now_us();
+        _r.level = level;
+        _r.category = category;
+        _r.length = 0;
+    }
+    ~LogLine() { Logger::instance().push(_r); }
+
+    LogLine(const LogLine&) = delete;
+    LogLine& operator=(const LogLine&) = delete;
+
+    LogLine& operator<<(std::string_view s) {
+        size_t n = std::min(s.size(), LogRecord::TEXT - _r.length);
+        std::memcpy(_r.text + _r.length, s.data(), n);
+        _r.length = static_cast<uint16_t>(_r.length + n);
+        return *this;
+    }
+    LogLine& operator<<(const char* s) { return *this << std::string_view(s ? s : "(null)"); }
+    LogLine& operator<<(const std::string& s) { return *this << std::string_view(s); }
+    LogLine& operator<<(char c) { return *this << std::string_view(&c, 1); }
+    LogLine& operator<<(bool b) { return *this << (b ? "true" : "false"); }
+
+    template <typename T, typename = std::enable_if_t<std::is_arithmetic<T>::value>>
+    LogLine& operator<<(T v) {
+        char buf[32];
+        int n;
+        if constexpr (std::is_floating_point<T>::value) n = std::snprintf(buf, sizeof(buf), "%g", static_cast<double>(v));
+        else if constexpr (std::is_signed<T>::value) n = std::snprintf(buf, sizeof(buf), "%lld", static_cast<long long>(v));
+        else n = std::snprintf(buf, sizeof(buf), "%llu", static_cast<unsigned long long>(v));
+        return *this << std::string_view(buf, n > 0 ? static_cast<size_t>(n) : 0);
+    }
+
+private:
+    LogRecord _r;
+};
+
+#define KFC_LOG(level, category, ...)                                                                   \
+    do {                                                                                                \
+        if constexpr (static_cast<int>(LogLevel::level) >= KFC_LOG_LEVEL) {                             \
+            if (Logger::instance().enabled(LogCategory::category, LogLevel::level)) {                   \
+                LogLine kfc_log_line_(LogLevel::level, LogCategory::category);                           \
+                kfc_log_line_ << __VA_ARGS__;                                                           \
+            }                                                                                           \
+        }                                                                                               \
+    } while (0)
+
+#define KFC_TRACE(category, ...) KFC_LOG(Trace, category, __VA_ARGS__)
+#define KFC_DEBUG(category, ...) KFC_LOG(Debug, category, __VA_ARGS__)
+#define KFC_INFO(category, ...) KFC_LOG(Info, category, __VA_ARGS__)
+#define KFC_WARN(category, ...) KFC_LOG(Warn, category, __VA_ARGS__)
+#define KFC_ERROR(category, ...) KFC_LOG(Error, category, __VA_ARGS__)
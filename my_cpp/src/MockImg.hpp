@@ -21,8 +21,9 @@ public:
         return *this;
     }
 
-    void draw_on(MockImg& other, int x, int y) {
+    bool draw_on(MockImg& other, int x, int y) {
         traj.emplace_back(x, y);
+        return true;
     }
 
     void put_text(const std::string& txt, int x, int y, double font_size, int thickness = 1) {
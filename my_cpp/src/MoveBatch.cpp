@@ -0,0 +1,107 @@
+#include "MoveBatch.hpp"
+#include <algorithm>
+#include <cmath>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__SSE2__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define KFC_MOVES_SSE2 1
+#include <emmintrin.h>
+#endif
+
+void MoveBatch::clear() {
+    piece.clear();
+    start_row.clear();
+    start_col.clear();
+    dir_row.clear();
+    dir_col.clear();
+    speed.clear();
+    length.clear();
+    start_ms.clear();
+    end_row.clear();
+    end_col.clear();
+    _index.clear();
+}
+
+bool MoveBatch::add(PieceHandle h, std::pair<int, int> src, std::pair<int, int> dst, float speed_cells_s, int32_t start_ms_) {
+    remove(h);
+    float dr = static_cast<float>(dst.first - src.first);
+    float dc = static_cast<float>(dst.second - src.second);
+    float len = std::hypot(dr, dc);
+    if (len == 0.0f || !(speed_cells_s > 0.0f)) return false;
+    if (h >= _index.size()) _index.resize(h + 1, NONE);
+    _index[h] = static_cast<uint32_t>(piece.size());
+    piece.push_back(h);
+    start_row.push_back(static_cast<float>(src.first));
+    start_col.push_back(static_cast<float>(src.second));
+    dir_row.push_back(dr / len);
+    dir_col.push_back(dc / len);
+    speed.push_back(speed_cells_s);
+    length.push_back(len);
+    start_ms.push_back(start_ms_);
+    end_row.push_back(static_cast<int8_t>(dst.first));
+    end_col.push_back(static_cast<int8_t>(dst.second));
+    return true;
+}
+
+bool MoveBatch::contains(PieceHandle h) const {
+    return h < _index.size() && _index[h] != NONE;
+}
+
+void MoveBatch::remove(PieceHandle h) {
+    if (contains(h)) _remove_at(_index[h]);
+}
+
+// Swap with the last entry and pop: order does not matter to the batch
+void MoveBatch::_remove_at(size_t i) {
+    size_t last = piece.size() - 1;
+    _index[piece[i]] = NONE;
+    if (i != last) _index[piece[last]] = static_cast<uint32_t>(i);
+    piece[i] = piece[last];
+    start_row[i] = start_row[last];
+    start_col[i] = start_col[last];
+    dir_row[i] = dir_row[last];
+    dir_col[i] = dir_col[last];
+    speed[i] = speed[last];
+    length[i] = length[last];
+    start_ms[i] = start_ms[last];
+    end_row[i] = end_row[last];
+    end_col[i] = end_col[last];
+    piece.pop_back();
+    start_row.pop_back();
+    start_col.pop_back();
+    dir_row.pop_back();
+    dir_col.pop_back();
+    speed.pop_back();
+    length.pop_back();
+    start_ms.pop_back();
+    end_row.pop_back();
+    end_col.pop_back();
+}
+
+void MoveBatch::integrate(int32_t now_ms, float* row, float* col, bool use_simd) const {
+    const size_t n = piece.size();
+    size_t i = 0;
+#ifdef KFC_MOVES_SSE2
+    if (use_simd) {
+        const __m128i now = _mm_set1_epi32(now_ms);
+        const __m128 ms_to_s = _mm_set1_ps(0.001f);
+        alignas(16) float r[4], c[4];
+        for (; i + 4 <= n; i += 4) {
+            __m128i start = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&start_ms[i]));
+            __m128 t = _mm_mul_ps(_mm_cvtepi32_ps(_mm_sub_epi32(now, start)), ms_to_s);
+            __m128 dist = _mm_min_ps(_mm_mul_ps(t, _mm_loadu_ps(&speed[i])), _mm_loadu_ps(&length[i]));
+            _mm_store_ps(r, _mm_add_ps(_mm_loadu_ps(&start_row[i]), _mm_mul_ps(_mm_loadu_ps(&dir_row[i]), dist)));
+            _mm_store_ps(c, _mm_add_ps(_mm_loadu_ps(&start_col[i]), _mm_mul_ps(_mm_loadu_ps(&dir_col[i]), dist)));
+            for (int k = 0; k < 4; ++k) {
+                row[piece[i + k]] = r[k];
+                col[piece[i + k]] = c[k];
+            }
+        }
+    }
+#endif
+    for (; i < n; ++i) {
+        float t = (now_ms - start_ms[i]) * 0.001f;
+        float dist = std::min(t * speed[i], length[i]);
+        row[piece[i]] = start_row[i] + dir_row[i] * dist;
+        col[piece[i]] = start_col[i] + dir_col[i] * dist;
+    }
+}
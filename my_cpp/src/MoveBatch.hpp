@@ -0,0 +1,44 @@
+#pragma once
+#include "Bitboard.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+// Every piece that is travelling, as parallel arrays, advanced together once
+// per frame instead of one virtual MovePhysics::update per piece. Same motion
+// as MovePhysics: straight line from the start cell at constant speed,
+// position clamped to the destination. Arrival is not detected here - it is
+// a deadline in Game's EventScheduler, which removes the move when it fires.
+class MoveBatch {
+public:
+    std::vector<PieceHandle> piece;
+    std::vector<float> start_row, start_col;
+    std::vector<float> dir_row, dir_col; // unit vector
+    std::vector<float> speed;            // cells per second
+    std::vector<float> length;           // cells
+    std::vector<int32_t> start_ms;
+    std::vector<int8_t> end_row, end_col;
+
+    size_t size() const { return piece.size(); }
+    bool empty() const { return piece.empty(); }
+    void clear();
+
+    // Replaces any move of the same piece. False (nothing added) for a
+    // zero-length move or a non-positive speed.
+    bool add(PieceHandle h, std::pair<int, int> src, std::pair<int, int> dst, float speed_cells_s, int32_t start_ms_);
+    void remove(PieceHandle h);
+
+    bool contains(PieceHandle h) const;
+
+    // Writes every moving piece's position to row[piece] / col[piece] (arrays
+    // indexed by PieceHandle, e.g. PieceStore::row/col). SSE2 runs four moves
+    // per step where available; use_simd = false forces the scalar path.
+    void integrate(int32_t now_ms, float* row, float* col, bool use_simd = true) const;
+
+private:
+    static constexpr uint32_t NONE = 0xFFFFFFFF;
+    std::vector<uint32_t> _index; // PieceHandle -> entry, NONE when not moving
+
+    void _remove_at(size_t i);
+};
@@ -9,6 +9,7 @@
 #include <algorithm>
 #include <cmath>
 #include <memory>
+#include "Bitboard.hpp"
 
 class Piece;
 
@@ -17,6 +18,11 @@ public:
     std::pair<int, int> dims;
     std::map<std::pair<int, int>, std::string> moves;
 
+    // moves.txt compiled per source square (row * 8 + col): destination masks
+    // for capture-only, quiet-only (non_capture) and untagged offsets. Empty
+    // when dims do not fit a 64-bit board; the offset map is used then.
+    std::vector<Bitboard> capture_mask, quiet_mask, either_mask;
+
     Moves(const std::string& moves_file, std::pair<int, int> dims_)
         : dims(dims_) {
         std::ifstream f(moves_file);
@@ -41,6 +47,35 @@ public:
             tag.erase(tag.find_last_not_of(" \t") + 1);
             moves[std::make_pair(dr, dc)] = tag;
         }
+        _compile_tables();
+    }
+
+    // Rules already compiled elsewhere (asset pack): no parsing, no table build.
+    Moves(std::map<std::pair<int, int>, std::string> moves_, std::pair<int, int> dims_,
+          std::vector<Bitboard> capture_mask_ = {}, std::vector<Bitboard> quiet_mask_ = {},
+          std::vector<Bitboard> either_mask_ = {})
+        : dims(dims_), moves(std::move(moves_)), capture_mask(std::move(capture_mask_)),
+          quiet_mask(std::move(quiet_mask_)), either_mask(std::move(either_mask_)) {
+        if (either_mask.empty()) _compile_tables();
+    }
+
+    bool has_tables() const { return !either_mask.empty(); }
+
+    // Every destination the move rules allow from src given the occupancy,
+    // clear path included when asked for; squares of my_color's side are
+    // never included, as in is_valid (Count skips that)
+    Bitboard legal_destinations(const std::pair<int, int>& src_cell, const Occupancy& occ, bool is_need_clear_path, PieceColor my_color) const {
+        if (!has_tables() || !on_board(src_cell.first, src_cell.second)) return 0;
+        int sq = square_of(src_cell);
+        Bitboard dst = either_mask[sq] | (capture_mask[sq] & occ.all) | (quiet_mask[sq] & ~occ.all);
+        if (my_color != PieceColor::Count) dst &= ~occ.color(my_color);
+        if (!is_need_clear_path) return dst;
+        Bitboard legal = 0;
+        for (Bitboard b = dst; b;) {
+            int to = pop_lsb(b);
+            if (!(path_mask(src_cell, cell_of(to)) & occ.all)) legal |= square_bb(to);
+        }
+        return legal;
     }
 
     static std::tuple<int, int, int> parse(const std::string& s) {
@@ -64,55 +99,105 @@ public:
         if (dst_has_piece && !dst_pieces) {
             // Dummy piece logic omitted for C++
         }
-        auto it = moves.find(std::make_pair(dr, dc));
-        if (it == moves.end()) return false;
-        const std::string& move_tag = it->second;
-        if (move_tag.empty()) {
-            if (dst_pieces) {
-                // Can't check friendly_pieces without knowing piece structure
-                // User should implement this logic
-            }
-            return true;
-        }
-        if (move_tag == "capture") {
-            // User should implement: check if dst_pieces has enemy pieces
-            return dst_pieces && !dst_pieces->empty();
-        }
-        if (move_tag == "non_capture") {
-            return !dst_pieces;
-        }
-        return false;
+        return _dst_allowed(dr, dc, dst_pieces != nullptr && !dst_pieces->empty());
     }
 
-    bool is_valid(const std::pair<int, int>& src_cell, const std::pair<int, int>& dst_cell, const std::map<std::pair<int, int>, std::vector<std::shared_ptr<Piece>>>& cell2piece, bool is_need_clear_path, const std::string& my_color) const {
-        if (!(0 <= dst_cell.first && dst_cell.first < dims.first && 0 <= dst_cell.second && dst_cell.second < dims.second))
+    // my_color is the mover's; a destination held by its own side is never
+    // legal (Count skips the check, e.g. for the std::map view)
+    bool is_valid(const std::pair<int, int>& src_cell, const std::pair<int, int>& dst_cell, const Occupancy& occ, bool is_need_clear_path, PieceColor my_color) const {
+        if (!on_board(dst_cell.first, dst_cell.second) || dst_cell.first >= dims.first || dst_cell.second >= dims.second)
             return false;
-        int dr = dst_cell.first - src_cell.first;
-        int dc = dst_cell.second - src_cell.second;
-        auto it = cell2piece.find(dst_cell);
-        const std::vector<std::shared_ptr<Piece>>* dst_pieces = (it != cell2piece.end()) ? &it->second : nullptr;
-        if (!is_dst_cell_valid(dr, dc, dst_pieces, &my_color))
+        if (my_color != PieceColor::Count && occ.is_friendly(square_of(dst_cell), my_color))
+            return false;
+        bool dst_occupied = occ.occupied(square_of(dst_cell));
+        if (has_tables() && on_board(src_cell.first, src_cell.second)) {
+            int sq = square_of(src_cell);
+            Bitboard allowed = either_mask[sq] | (dst_occupied ? capture_mask[sq] : quiet_mask[sq]);
+            if (!(allowed & square_bb(square_of(dst_cell))))
+                return false;
+        } else if (!_dst_allowed(dst_cell.first - src_cell.first, dst_cell.second - src_cell.second, dst_occupied)) {
             return false;
-        if (is_need_clear_path && !_path_is_clear(src_cell, dst_cell, cell2piece, my_color))
+        }
+        if (is_need_clear_path && !_path_is_clear(src_cell, dst_cell, occ))
             return false;
         return true;
     }
 
-    bool _path_is_clear(const std::pair<int, int>& src_cell, const std::pair<int, int>& dst_cell, const std::map<std::pair<int, int>, std::vector<std::shared_ptr<Piece>>>& cell2piece, const std::string& my_color) const {
+    // std::map view of the board, kept for callers that have not moved to
+    // Occupancy; it carries no colors, so friendly pieces are not told apart
+    bool is_valid(const std::pair<int, int>& src_cell, const std::pair<int, int>& dst_cell, const std::map<std::pair<int, int>, std::vector<std::shared_ptr<Piece>>>& cell2piece, bool is_need_clear_path, PieceColor my_color) const {
+        return is_valid(src_cell, dst_cell, Occupancy::from_cell_map(cell2piece), is_need_clear_path, my_color);
+    }
+
+    // Squares strictly between src and dst. Straight and diagonal moves come
+    // from the ray tables; other offsets (knight jumps) keep the original
+    // truncating walk, which looks at one orthogonal neighbour.
+    static Bitboard path_mask(const std::pair<int, int>& src_cell, const std::pair<int, int>& dst_cell) {
         int dr = dst_cell.first - src_cell.first;
         int dc = dst_cell.second - src_cell.second;
+        int dir = RayTables::direction(dr, dc);
+        if (dir >= 0 && on_board(src_cell.first, src_cell.second) && on_board(dst_cell.first, dst_cell.second))
+            return ray_tables().between(square_of(src_cell), square_of(dst_cell), dir);
         int steps = std::max(std::abs(dr), std::abs(dc));
-        if (steps == 0) return true;
+        Bitboard mask = 0;
+        if (steps == 0) return mask;
         float step_r = dr / static_cast<float>(steps);
         float step_c = dc / static_cast<float>(steps);
         for (int i = 1; i < steps; ++i) {
             int r = src_cell.first + static_cast<int>(i * step_r);
             int c = src_cell.second + static_cast<int>(i * step_c);
-            if (cell2piece.find(std::make_pair(r, c)) != cell2piece.end()) {
-                std::cout << "Path not clear at (" << r << "," << c << ") - piece blocking" << std::endl;
-                return false;
+            if (on_board(r, c)) mask |= square_bb(square_of(r, c));
+        }
+        return mask;
+    }
+
+    bool _path_is_clear(const std::pair<int, int>& src_cell, const std::pair<int, int>& dst_cell, const Occupancy& occ) const {
+        return (path_mask(src_cell, dst_cell) & occ.all) == 0;
+    }
+
+    bool _path_is_clear(const std::pair<int, int>& src_cell, const std::pair<int, int>& dst_cell, const std::map<std::pair<int, int>, std::vector<std::shared_ptr<Piece>>>& cell2piece, const std::string& my_color) const {
+        return _path_is_clear(src_cell, dst_cell, Occupancy::from_cell_map(cell2piece));
+    }
+
+private:
+    void _compile_tables() {
+        capture_mask.clear();
+        quiet_mask.clear();
+        either_mask.clear();
+        if (dims.first <= 0 || dims.second <= 0 || dims.first > BOARD_DIM || dims.second > BOARD_DIM) return;
+        capture_mask.assign(SQUARE_COUNT, 0);
+        quiet_mask.assign(SQUARE_COUNT, 0);
+        either_mask.assign(SQUARE_COUNT, 0);
+        for (int r = 0; r < dims.first; ++r) {
+            for (int c = 0; c < dims.second; ++c) {
+                int sq = square_of(r, c);
+                for (const auto& [offset, tag] : moves) {
+                    int tr = r + offset.first, tc = c + offset.second;
+                    if (tr < 0 || tr >= dims.first || tc < 0 || tc >= dims.second) continue;
+                    Bitboard to = square_bb(square_of(tr, tc));
+                    if (tag.empty()) either_mask[sq] |= to;
+                    else if (tag == "capture") capture_mask[sq] |= to;
+                    else if (tag == "non_capture") quiet_mask[sq] |= to;
+                    // unknown tags never allow a move, as in _dst_allowed
+                }
             }
         }
-        return true;
+    }
+
+    bool _dst_allowed(int dr, int dc, bool dst_occupied) const {
+        auto it = moves.find(std::make_pair(dr, dc));
+        if (it == moves.end()) return false;
+        const std::string& move_tag = it->second;
+        if (move_tag.empty()) {
+            // Can't check friendly pieces here - any destination is accepted
+            return true;
+        }
+        if (move_tag == "capture") {
+            return dst_occupied;
+        }
+        if (move_tag == "non_capture") {
+            return !dst_occupied;
+        }
+        return false;
     }
 };
@@ -0,0 +1,106 @@
+#pragma once
+#include "Moves.hpp"
+#include <array>
+#include <filesystem>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+
+// Process-wide store of move rules, one immutable Moves per (piece type,
+// color, state) - the rules differ per color (pawns). Each moves.txt is read
+// the first time its rules are asked for; every piece of that kind shares
+// the same handle afterwards, so validating a move never touches the disk.
+// Lookups take the piece's enums; the string piece code ("PW") is only
+// parsed by the load-time overloads.
+class MovesRegistry {
+public:
+    using Handle = std::shared_ptr<const Moves>;
+
+    static MovesRegistry& instance() {
+        static MovesRegistry registry;
+        return registry;
+    }
+
+    // Rules for (type, color, state), loaded from moves_file on first use.
+    // Returns nullptr when the state has no moves.txt.
+    Handle load(PieceType type, PieceColor color, const std::string& state,
+                const std::filesystem::path& moves_file, std::pair<int, int> dims) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        auto& states = _rules[_index(type, color)];
+        auto it = states.find(state);
+        if (it != states.end()) return it->second;
+        Handle rules;
+        if (std::filesystem::exists(moves_file)) {
+            rules = std::make_shared<const Moves>(moves_file.string(), dims);
+            ++_file_loads;
+        }
+        states.emplace(state, rules);
+        return rules;
+    }
+
+    // Registers rules built elsewhere (asset pack). An existing entry wins,
+    // so every piece keeps sharing one handle per (type, state).
+    Handle adopt(PieceType type, PieceColor color, const std::string& state, Handle rules) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _rules[_index(type, color)].emplace(state, std::move(rules)).first->second;
+    }
+
+    // Piece code ("PW", a pieces/ directory name) versions of the above
+    Handle load(const std::string& piece_code, const std::string& state,
+                const std::filesystem::path& moves_file, std::pair<int, int> dims) {
+        auto [type, color] = _parse(piece_code);
+        return load(type, color, state, moves_file, dims);
+    }
+    Handle adopt(const std::string& piece_code, const std::string& state, Handle rules) {
+        auto [type, color] = _parse(piece_code);
+        return adopt(type, color, state, std::move(rules));
+    }
+
+    // Already loaded rules, or nullptr. Never reads files.
+    Handle find(PieceType type, PieceColor color, std::string_view state) const {
+        if (type == PieceType::Count || color == PieceColor::Count) return nullptr;
+        std::lock_guard<std::mutex> lock(_mutex);
+        const auto& states = _rules[_index(type, color)];
+        auto s = states.find(state);
+        return s != states.end() ? s->second : nullptr;
+    }
+
+    size_t file_loads() const {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _file_loads;
+    }
+
+    // Drops every rule set; pieces keep the handles they already hold.
+    void clear() {
+        std::lock_guard<std::mutex> lock(_mutex);
+        for (auto& states : _rules) states.clear();
+        _file_loads = 0;
+    }
+
+private:
+    MovesRegistry() = default;
+
+    static constexpr size_t COLORS = static_cast<size_t>(PieceColor::Count);
+    static constexpr size_t KINDS = static_cast<size_t>(PieceType::Count) * COLORS;
+
+    mutable std::mutex _mutex;
+    std::array<std::map<std::string, Handle, std::less<>>, KINDS> _rules; // by _index(type, color)
+    size_t _file_loads = 0;
+
+    static size_t _index(PieceType type, PieceColor color) {
+        return static_cast<size_t>(type) * COLORS + static_cast<size_t>(color);
+    }
+
+    static std::pair<PieceType, PieceColor> _parse(const std::string& piece_code) {
+        PieceType type;
+        PieceColor color;
+        if (!parse_piece_code(piece_code, type, color))
+            throw std::runtime_error("Unknown piece code for move rules: " + piece_code);
+        return {type, color};
+    }
+};
@@ -0,0 +1,72 @@
+#pragma once
+#include "Command.hpp"
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <string>
+#include <string_view>
+
+// Small integer ids for state and event names, assigned as piece types are
+// loaded. The game compares and indexes by id; name() keeps the text around
+// for logs and tooling. Ids are dense (0, 1, 2, ...) and never reused.
+using NameId = uint16_t;
+using StateId = NameId;
+using EventId = NameId;
+constexpr NameId NO_NAME = 0xFFFF;
+
+class NameInterner {
+public:
+    NameId intern(std::string_view name) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        auto it = _ids.find(name);
+        if (it != _ids.end()) return it->second;
+        NameId id = static_cast<NameId>(_names.size());
+        _names.emplace_back(name);
+        _ids.emplace(_names.back(), id);
+        return id;
+    }
+
+    // NO_NAME when the name was never interned.
+    NameId find(std::string_view name) const {
+        std::lock_guard<std::mutex> lock(_mutex);
+        auto it = _ids.find(name);
+        return it != _ids.end() ? it->second : NO_NAME;
+    }
+
+    // References stay valid: names are never removed or moved.
+    const std::string& name(NameId id) const {
+        static const std::string unknown;
+        std::lock_guard<std::mutex> lock(_mutex);
+        return id < _names.size() ? _names[id] : unknown;
+    }
+
+    size_t size() const {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _names.size();
+    }
+
+private:
+    mutable std::mutex _mutex;
+    std::deque<std::string> _names;
+    std::map<std::string_view, NameId, std::less<>> _ids; // views into _names
+};
+
+inline NameInterner& state_names() {
+    static NameInterner names;
+    return names;
+}
+
+// Seeded with the EventKind names so that EventId == EventKind for the
+// built-in events; events only known from transitions.csv come after them.
+inline NameInterner& event_names() {
+    static NameInterner names;
+    static const bool seeded = [] {
+        for (int k = 0; k < static_cast<int>(EventKind::Count); ++k) names.intern(event_name(static_cast<EventKind>(k)));
+        return true;
+    }();
+    (void)seeded;
+    return names;
+}
+
+inline EventId event_id(EventKind kind) { return static_cast<EventId>(kind); }
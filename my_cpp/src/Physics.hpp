@@ -1,13 +1,16 @@
 #pragma once
 #include "Board.hpp"
 #include "Command.hpp"
+#include "Faults.hpp"
+#include "Log.hpp"
 #include "Sound.hpp"
 #include <cmath>
+#include <cstdint>
 #include <vector>
 #include <memory>
 #include <algorithm>
-#include <any>
 #include <iostream>
+#include <optional>
 #include <utility>
 
 class BasePhysics {
@@ -19,26 +22,27 @@ public:
     float param;
     int _start_ms;
     bool do_i_need_clear_path;
+    Fault fault = Fault::None; // why the last reset refused the command
 
     BasePhysics(const Board& board_, float param_ = 1.0f)
-        : board(board_), param(param_), _start_ms(0), do_i_need_clear_path(true), _curr_pos_m{0.0f, 0.0f} {
+        : board(board_), _start_cell{0, 0}, _end_cell{0, 0}, _curr_pos_m{0.0f, 0.0f}, param(param_), _start_ms(0), do_i_need_clear_path(true) {
     }
 
     virtual ~BasePhysics() = default; // Destructor is already defined
 
-    virtual bool reset(const Command& cmd) = 0;
-    virtual std::unique_ptr<Command> update(int now_ms) = 0;
+    // The cell vectors always hold two entries and are written in place, so
+    // reset/update never allocate. "done" events come back by value.
+    virtual bool reset(const TypedCommand& cmd) = 0;
+    virtual std::optional<TypedCommand> update(int now_ms) = 0;
+
+    bool reset(const Command& cmd) { return reset(to_typed(cmd)); }
 
     std::vector<float> get_pos_m() const {
         return _curr_pos_m;
     }
     std::pair<int, int> get_pos_pix() const {
         if (_curr_pos_m.size() < 2) return {0,0};
-        try {
-            return board.m_to_pix({_curr_pos_m[0], _curr_pos_m[1]});
-        } catch (...) {
-            return {0,0};
-        }
+        return board.m_to_pix({_curr_pos_m[0], _curr_pos_m[1]});
     }
     virtual std::pair<int, int> get_curr_cell() const {
         if (_curr_pos_m.size() < 2) return {0,0};
@@ -47,35 +51,55 @@ public:
         return {row, col};
     }
     int get_start_ms() const { return _start_ms; }
+    // Cells per second along (row, col) while travelling, 0 otherwise
+    virtual std::pair<float, float> velocity() const { return {0.0f, 0.0f}; }
+    // Ends any travel at `cell` (arrival comes from Game's EventScheduler, not update())
+    virtual void stop_at(std::pair<int, int> cell) {
+        _curr_pos_m[0] = static_cast<float>(cell.first);
+        _curr_pos_m[1] = static_cast<float>(cell.second);
+    }
+    // Game time at which update() reports "done", nullopt for states that
+    // never end by themselves. Game schedules this instead of polling update().
+    virtual std::optional<int64_t> deadline_ms() const { return std::nullopt; }
     virtual bool can_be_captured() const { return true; }
     virtual bool can_capture() const { return true; }
     virtual bool is_movement_blocker() const { return false; }
     bool is_need_clear_path() const { return do_i_need_clear_path; }
+
+protected:
+    static void _set_cell(std::vector<int>& cell, CommandCell c) {
+        cell[0] = c.row;
+        cell[1] = c.col;
+    }
+    void _set_pos(const std::vector<int>& cell) {
+        _curr_pos_m[0] = static_cast<float>(cell[0]);
+        _curr_pos_m[1] = static_cast<float>(cell[1]);
+    }
+    // First whole millisecond at which update()'s `ms / 1000.0f >= seconds` holds
+    static int64_t _ms_until(float seconds) {
+        if (!(seconds > 0.0f)) return 0;
+        int64_t ms = static_cast<int64_t>(std::ceil(seconds * 1000.0f));
+        while (ms > 0 && (ms - 1) / 1000.0f >= seconds) --ms;
+        while (ms / 1000.0f < seconds) ++ms;
+        return ms;
+    }
 };
 
 class IdlePhysics : public BasePhysics {
 public:
     IdlePhysics(const Board& board_, float param_ = 1.0f) : BasePhysics(board_, param_) {}
-    bool reset(const Command& cmd) override {
-        if (cmd.params.empty()) {
-            return false;
-        }
-        try {
-            auto cell_vec = std::any_cast<std::vector<int>>(cmd.params[0]);
-            if (cell_vec.size() < 2) {
-                return false;
-            }
-            _end_cell = _start_cell = cell_vec;
-            // Use cell coordinates directly as "meters" to avoid precision issues
-            _curr_pos_m = {static_cast<float>(_start_cell[0]), static_cast<float>(_start_cell[1])};
-
-            _start_ms = cmd.timestamp;
-        } catch (const std::bad_any_cast& e) {
+    bool reset(const TypedCommand& cmd) override {
+        if (cmd.cell_count < 1) {
             return false;
         }
+        _set_cell(_start_cell, cmd.src);
+        _set_cell(_end_cell, cmd.src);
+        // Use cell coordinates directly as "meters" to avoid precision issues
+        _set_pos(_start_cell);
+        _start_ms = cmd.timestamp;
         return true;
     }
-    std::unique_ptr<Command> update(int /*now_ms*/) override { return nullptr; }
+    std::optional<TypedCommand> update(int /*now_ms*/) override { return std::nullopt; }
     bool can_capture() const override { return false; }
     bool is_movement_blocker() const override { return true; }
 };
@@ -87,46 +111,33 @@ public:
     std::vector<float> _movement_vector;
     float _movement_vector_length;
     float _duration_s;
+    bool _moving = false;
 
     MovePhysics(const Board& board_, float param_ = 1.0f)
-        : BasePhysics(board_, param_), sound(), _speed_m_s(param_) {
-        if (_speed_m_s == 0) throw std::runtime_error("_speed_m_s is 0");
+        : BasePhysics(board_, param_), sound(), _speed_m_s(param_), _movement_vector{0.0f, 0.0f}, _movement_vector_length(0.0f), _duration_s(0.0f) {
         if (_speed_m_s < 0) _speed_m_s = std::abs(_speed_m_s);
     }
     bool can_be_captured() const override { return false; }
-    bool reset(const Command& cmd) override {
-        for (size_t i = 0; i < cmd.params.size(); ++i) {
-        }
+    // A zero speed is reported through `fault` and the piece does not move
+    bool reset(const TypedCommand& cmd) override {
         // sound.play("../../sounds/foot_step.wav"); // Removed - sound handled by Game class
-        // Defensive: check params size
-        if (cmd.params.size() < 2) {
+        _moving = false;
+        fault = Fault::None;
+        if (!(_speed_m_s > 0.0f)) {
+            fault = Fault::ZeroSpeed;
             return false;
         }
-        // Defensive: check any_cast and vector size
-        try {
-            _start_cell = std::any_cast<std::vector<int>>(cmd.params[0]);
-            _end_cell = std::any_cast<std::vector<int>>(cmd.params[1]);
-        } catch (const std::bad_any_cast& e) {
+        if (cmd.cell_count < 2) {
             return false;
         }
-        if (_start_cell.size() < 2 || _end_cell.size() < 2) {
-            return false;
-        }
-        for (size_t i = 0; i < _start_cell.size(); ++i) {
-            std::cout << _start_cell[i];
-            if (i + 1 < _start_cell.size()) std::cout << ", ";
-        }
-        std::cout << "]\n";
-        for (size_t i = 0; i < _end_cell.size(); ++i) {
-            std::cout << _end_cell[i];
-            if (i + 1 < _end_cell.size()) std::cout << ", ";
-        }
-        std::cout << "]\n";
-        _curr_pos_m = {static_cast<float>(_start_cell[0]), static_cast<float>(_start_cell[1])};
+        _set_cell(_start_cell, cmd.src);
+        _set_cell(_end_cell, cmd.dst);
+        KFC_DEBUG(Physics, "move [" << _start_cell[0] << ", " << _start_cell[1] << "] -> [" << _end_cell[0] << ", "
+                                    << _end_cell[1] << "]");
+        _set_pos(_start_cell);
         _start_ms = cmd.timestamp;
-        std::vector<float> start_pos = {static_cast<float>(_start_cell[0]), static_cast<float>(_start_cell[1])};
-        std::vector<float> end_pos = {static_cast<float>(_end_cell[0]), static_cast<float>(_end_cell[1])};
-        _movement_vector = {end_pos[0] - start_pos[0], end_pos[1] - start_pos[1]};
+        _movement_vector[0] = static_cast<float>(_end_cell[0] - _start_cell[0]);
+        _movement_vector[1] = static_cast<float>(_end_cell[1] - _start_cell[1]);
         _movement_vector_length = std::hypot(_movement_vector[0], _movement_vector[1]);
         if (_movement_vector_length == 0.0f) {
             return false;
@@ -134,13 +145,14 @@ public:
         _movement_vector[0] /= _movement_vector_length;
         _movement_vector[1] /= _movement_vector_length;
         _duration_s = _movement_vector_length / _speed_m_s;
+        _moving = true;
         return true;
     }
-    std::unique_ptr<Command> update(int now_ms) override {
+    std::optional<TypedCommand> update(int now_ms) override {
         float seconds_passed = (now_ms - _start_ms) / 1000.0f;
         if (_curr_pos_m.size() < 2 || _movement_vector.size() < 2) {
-            std::cout << "[ERROR] MovePhysics::update: vector too small! _curr_pos_m.size()=" << _curr_pos_m.size() << ", _movement_vector.size()=" << _movement_vector.size() << std::endl;
-            return nullptr;
+            KFC_ERROR(Physics, "MovePhysics::update: vector too small! _curr_pos_m.size()=" << _curr_pos_m.size() << ", _movement_vector.size()=" << _movement_vector.size());
+            return std::nullopt;
         }
         // Calculate position based on distance traveled from start, not incremental addition
         float distance_traveled = std::min(seconds_passed * _speed_m_s, _movement_vector_length);
@@ -148,12 +160,26 @@ public:
         _curr_pos_m[1] = static_cast<float>(_start_cell[1]) + _movement_vector[1] * distance_traveled;
         if (seconds_passed >= _duration_s) {
             sound.stop();
-            return std::make_unique<Command>(now_ms, "", "done", std::vector<std::any>{});
+            _moving = false;
+            return TypedCommand::done(now_ms, {_end_cell[0], _end_cell[1]});
         }
-        return nullptr;
+        return std::nullopt;
     }
     std::vector<float> get_pos_m() const { return _curr_pos_m; }
     std::pair<int, int> get_pos_pix() const { return BasePhysics::get_pos_pix(); }
+    std::pair<float, float> velocity() const override {
+        if (!_moving) return {0.0f, 0.0f};
+        return {_movement_vector[0] * _speed_m_s, _movement_vector[1] * _speed_m_s};
+    }
+    void stop_at(std::pair<int, int> cell) override {
+        BasePhysics::stop_at(cell);
+        sound.stop();
+        _moving = false;
+    }
+    std::optional<int64_t> deadline_ms() const override {
+        if (!_moving) return std::nullopt;
+        return _start_ms + _ms_until(_duration_s);
+    }
 };
 
 class StaticTemporaryPhysics : public BasePhysics {
@@ -161,33 +187,36 @@ public:
     float duration_s;
     StaticTemporaryPhysics(const Board& board_, float param_ = 1.0f) : BasePhysics(board_, param_), duration_s(param_) {
     }
-    bool reset(const Command& cmd) override {
-        _end_cell = _start_cell = std::any_cast<std::vector<int>>(cmd.params[0]);
-        _curr_pos_m = {static_cast<float>(_start_cell[0]), static_cast<float>(_start_cell[1])};
+    bool reset(const TypedCommand& cmd) override {
+        if (cmd.cell_count < 1) return false;
+        _set_cell(_start_cell, cmd.src);
+        _set_cell(_end_cell, cmd.src);
+        _set_pos(_start_cell);
         _start_ms = cmd.timestamp;
         return false;
     }
-    std::unique_ptr<Command> update(int now_ms) override {
+    std::optional<TypedCommand> update(int now_ms) override {
         float seconds_passed = (now_ms - _start_ms) / 1000.0f;
         if (seconds_passed >= duration_s) {
-            return std::make_unique<Command>(now_ms, "", "done", std::vector<std::any>{});
+            return TypedCommand::done(now_ms, {_end_cell[0], _end_cell[1]});
         }
-        return nullptr;
+        return std::nullopt;
     }
+    std::optional<int64_t> deadline_ms() const override { return _start_ms + _ms_until(duration_s); }
 };
 
 class JumpPhysics : public StaticTemporaryPhysics {
 public:
     JumpPhysics(const Board& board_, float param_ = 1.0f) : StaticTemporaryPhysics(board_, param_) {
     }
-    bool reset(const Command& cmd) override {
-        if (cmd.params.size() == 1) {
+    bool reset(const TypedCommand& cmd) override {
+        if (cmd.cell_count < 2) {
             StaticTemporaryPhysics::reset(cmd);
             return false;
         }
-        _start_cell = std::any_cast<std::vector<int>>(cmd.params[0]);
-        _end_cell = std::any_cast<std::vector<int>>(cmd.params[1]);
-        _curr_pos_m = {static_cast<float>(_end_cell[0]), static_cast<float>(_end_cell[1])};
+        _set_cell(_start_cell, cmd.src);
+        _set_cell(_end_cell, cmd.dst);
+        _set_pos(_end_cell);
         _start_ms = cmd.timestamp;
         return false;
     }
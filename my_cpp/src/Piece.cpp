@@ -1,6 +1,8 @@
 
 #include "Piece.hpp"
 #include "Board.hpp"
+#include "PieceStore.hpp"
+#include <cmath>
 #include <string>
 #include <map>
 #include <vector>
@@ -9,14 +11,81 @@
 
 bool Piece::on_command(const Command& cmd, std::map<std::pair<int, int>, std::vector<std::shared_ptr<Piece>>>& cell2piece) {
     if (!state) {
-        std::cout << "[ERROR] Piece::on_command: state nullptr for " << id << std::endl;
+        KFC_ERROR(Game, "Piece::on_command: state nullptr for " << id);
         return false;
     }
-    char my_color = id[1];
-    std::string my_color_str(1, my_color);
     bool flag;
-    std::shared_ptr<State> new_state;
-    std::tie(new_state, flag) = state->on_command(cmd, &cell2piece, my_color_str);
+    State* new_state;
+    std::tie(new_state, flag) = state->on_command(cmd, &cell2piece, piece_color);
     state = new_state;
+    publish();
     return flag;
 }
+
+bool Piece::on_command(const Command& cmd, const Occupancy& occ) {
+    return on_command(to_typed(cmd), occ);
+}
+
+bool Piece::on_command(const TypedCommand& cmd, const Occupancy& occ, Fault* fault) {
+    if (!state) {
+        if (fault) *fault = Fault::NoState;
+        return false;
+    }
+    bool flag;
+    State* new_state;
+    std::tie(new_state, flag) = state->on_command(cmd, &occ, piece_color, fault);
+    state = new_state;
+    publish();
+    return flag;
+}
+
+std::pair<int, int> Piece::current_cell() const {
+    if (store && store->holds(handle, this) && store->valid[handle])
+        return store->cell(handle);
+    if (!state || !state->physics) return {0, 0};
+    return state->physics->get_curr_cell();
+}
+
+void Piece::publish() {
+    if (store && store->holds(handle, this)) store->sync(handle);
+}
+
+std::pair<float, float> Piece::position() const {
+    if (store && store->holds(handle, this)) return {store->row[handle], store->col[handle]};
+    if (!state || !state->physics) return {0.0f, 0.0f};
+    return {state->physics->_curr_pos_m[0], state->physics->_curr_pos_m[1]};
+}
+
+void PieceStore::_attach(Piece* p, PieceHandle h) {
+    p->store = this;
+    p->handle = h;
+    sync(h);
+}
+
+void PieceStore::sync(PieceHandle h) {
+    const Piece* p = piece[h];
+    bool was_valid = valid[h] != 0;
+    PieceColor old_color = color[h];
+    PieceType old_type = type[h];
+    valid[h] = 0;
+    if (!p || !p->state || !p->state->physics) {
+        _reindex(h, false);
+        return;
+    }
+    const BasePhysics& ph = *p->state->physics;
+    auto vel = ph.velocity();
+    // A move already in flight keeps the position MoveBatch integrated
+    bool same_move = was_valid && (vel.first != 0.0f || vel.second != 0.0f) && state[h] == p->state->id &&
+                     start_ms[h] == ph._start_ms;
+    if (!same_move) {
+        row[h] = ph._curr_pos_m[0];
+        col[h] = ph._curr_pos_m[1];
+    }
+    std::tie(vel_row[h], vel_col[h]) = vel;
+    start_ms[h] = ph._start_ms;
+    state[h] = p->state->id;
+    type[h] = p->piece_type;
+    color[h] = p->piece_color;
+    valid[h] = 1;
+    _reindex(h, color[h] != old_color || type[h] != old_type);
+}
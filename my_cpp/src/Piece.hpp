@@ -5,40 +5,75 @@
 #include <map>
 #include <memory>
 #include <utility>
+#include <algorithm>
 #include <cstdint>
 #include "Command.hpp"
 #include "State.hpp"
 
+class PieceStore;
+
 class Piece {
     Piece(const Piece&) = delete;
     Piece& operator=(const Piece&) = delete;
     Piece(Piece&&) = delete;
     Piece& operator=(Piece&&) = delete;
 public:
+    // Text for display, logs and id-keyed maps: piece code + "_row,col" of
+    // the start cell. Game logic compares the enums below instead.
     std::string id;
-    std::shared_ptr<State> state;
+    PieceType piece_type = PieceType::Count; // Count when id has no piece code
+    PieceColor piece_color = PieceColor::Count;
+    // The piece's state machine, one State per state of its type. `state`
+    // points into it; switching states is a pointer assignment.
+    std::vector<std::unique_ptr<State>> states;
+    State* state;
+    // Set by PieceStore::assign; the row this piece publishes to
+    PieceStore* store = nullptr;
+    PieceHandle handle = NO_PIECE;
 
-    Piece(const std::string& piece_id, std::shared_ptr<State> init_state)
-        : id(piece_id), state(init_state) {
-        if (!state) std::cout << " (state is nullptr)";
-        else if (!state->physics) std::cout << " (physics is nullptr)";
-        std::cout << std::endl;
+    Piece(const std::string& piece_id, std::vector<std::unique_ptr<State>> states_, State* init_state)
+        : id(piece_id), states(std::move(states_)), state(init_state) {
+        if (!parse_piece_code(id, piece_type, piece_color)) {
+            piece_type = PieceType::Count;
+            piece_color = PieceColor::Count;
+        }
+        if (!state) KFC_WARN(Game, id << " (state is nullptr)");
+        else if (!state->physics) KFC_WARN(Game, id << " (physics is nullptr)");
     }
 
     bool on_command(const Command& cmd, std::map<std::pair<int, int>, std::vector<std::shared_ptr<Piece>>>& cell2piece);
+    bool on_command(const Command& cmd, const Occupancy& occ);
+    // `fault` (optional) says why a command was dropped rather than rejected
+    bool on_command(const TypedCommand& cmd, const Occupancy& occ, Fault* fault = nullptr);
+
+    // Pushes the current state/physics into the store row. Called by
+    // update/on_command/reset; call it after changing physics directly.
+    void publish();
+
+    // Read through the store when attached, from the objects otherwise
+    std::pair<float, float> position() const;
+    PieceColor color() const { return piece_color; }
+    PieceType type() const { return piece_type; }
+
+    // Changes the type (promotion) and the code at the start of the id
+    void set_type(PieceType t) {
+        piece_type = t;
+        id = piece_code(piece_type, piece_color) + id.substr(std::min<size_t>(2, id.size()));
+        publish();
+    }
 
     bool reset(int start_ms) {
-        auto cell = current_cell();
-        std::vector<int> cell_vec{cell.first, cell.second};
-        bool flag = state->reset(Command(start_ms, id, "idle", {cell_vec}));
+        bool flag = state->reset(TypedCommand::idle(start_ms, current_cell()));
+        publish();
         return flag;
     }
 
     bool update(int now_ms) {
         bool flag;
-        std::shared_ptr<State> new_state;
+        State* new_state;
         std::tie(new_state, flag) = state->update(now_ms);
         state = new_state;
+        publish();
         return flag;
     }
 
@@ -46,34 +81,29 @@ public:
         return state->physics->is_movement_blocker();
     }
 
-    void draw_on_board(const Board& board, int now_ms) {
-        if (!state || !state->physics || !state->graphics) return;
-        
-        try {
-            auto pos = state->physics->get_pos_pix();
-            int x = pos.first;
-            int y = pos.second;
-            if (x == std::numeric_limits<int>::min() || y == std::numeric_limits<int>::min()) {
-                return;
-            }
-            auto sprite_const = state->graphics->get_img();
-            Img sprite = sprite_const;
-            int center_offset_x = (board.cell_W_pix - sprite.img.cols) / 2;
-            int center_offset_y = (board.cell_H_pix - sprite.img.rows) / 2;
-            int centered_x = x + center_offset_x;
-            int centered_y = y + center_offset_y;
-            sprite.draw_on(const_cast<Img&>(board.img), centered_x, centered_y);
-        } catch (...) {
-            // שגיאה בציור
-        }
-    }
+    Fault draw_on_board(const Board& board, int now_ms) {
+        if (!state) return Fault::NoState;
+        if (!state->physics) return Fault::NoPhysics;
+        if (!state->graphics) return Fault::NoGraphics;
 
-    std::pair<int, int> current_cell() const {
-        if (!state || !state->physics) return {0,0};
-        try {
-            return state->physics->get_curr_cell();
-        } catch (...) {
-            return {0, 0};
+        auto pos = state->physics->get_pos_pix();
+        int x = pos.first;
+        int y = pos.second;
+        if (x == std::numeric_limits<int>::min() || y == std::numeric_limits<int>::min()) {
+            return Fault::None;
         }
+        const Img* sprite = state->graphics->get_img();
+        if (!sprite) return Fault::NoFrame;
+        int center_offset_x = (board.cell_W_pix - sprite->img.cols) / 2;
+        int center_offset_y = (board.cell_H_pix - sprite->img.rows) / 2;
+        int centered_x = x + center_offset_x;
+        int centered_y = y + center_offset_y;
+        // שגיאה בציור
+        if (!sprite->draw_on(const_cast<Img&>(board.img), centered_x, centered_y)) return Fault::ImageNotLoaded;
+        return Fault::None;
     }
+
+    // From the store row when attached: a travelling piece's position is
+    // advanced there by MoveBatch, not in its physics
+    std::pair<int, int> current_cell() const;
 };
@@ -3,8 +3,11 @@
 #include "Command.hpp"
 #include "GraphicsFactory.hpp"
 #include "Moves.hpp"
+#include "MovesRegistry.hpp"
 #include "PhysicsFactory.hpp"
 #include "Piece.hpp"
+#include "PieceTemplate.hpp"
+#include "SpriteAtlas.hpp"
 #include "State.hpp"
 #include <filesystem>
 #include <fstream>
@@ -22,14 +25,18 @@ public:
     std::shared_ptr<GraphicsFactory> graphics_factory;
     std::shared_ptr<PhysicsFactory> physics_factory;
     std::filesystem::path pieces_root;
+    // Optional: frames already decoded at cell size, reused instead of decoding again
+    std::shared_ptr<const SpriteAtlas> sprite_atlas;
 
     PieceFactory(const Board& board_, const std::filesystem::path& pieces_root_,
                  std::shared_ptr<GraphicsFactory> graphics_factory_ = nullptr,
-                 std::shared_ptr<PhysicsFactory> physics_factory_ = nullptr)
+                 std::shared_ptr<PhysicsFactory> physics_factory_ = nullptr,
+                 std::shared_ptr<const SpriteAtlas> sprite_atlas_ = nullptr)
         : board(board_),
           graphics_factory(graphics_factory_ ? graphics_factory_ : std::make_shared<GraphicsFactory>()),
           physics_factory(physics_factory_ ? physics_factory_ : std::make_shared<PhysicsFactory>(board_)),
-          pieces_root(pieces_root_) {}
+          pieces_root(pieces_root_),
+          sprite_atlas(std::move(sprite_atlas_)) {}
 
     static std::map<std::string, std::map<std::string, std::string>> _load_master_csv(const std::filesystem::path& pieces_root) {
         std::map<std::string, std::map<std::string, std::string>> _global_trans;
@@ -54,79 +61,108 @@ public:
         return _global_trans;
     }
 
-    std::shared_ptr<State> _build_state_machine(const std::filesystem::path& piece_dir, std::pair<int, int> cell) {
-        // Always build a fresh state machine for each piece, with correct initial cell
+    // Parses the type's directory (transitions, configs, moves, sprites) the
+    // first time the type is asked for; later pieces reuse the result.
+    std::shared_ptr<const PieceTemplate> get_template(const std::string& p_type) {
+        auto it = _templates.find(p_type);
+        if (it != _templates.end()) return it->second;
+
+        auto piece_dir = pieces_root / p_type;
         std::pair<int, int> board_size = {board.W_cells, board.H_cells};
         std::pair<int, int> cell_px = {board.cell_W_pix, board.cell_H_pix};
-        auto _global_trans = _load_master_csv(piece_dir / "states");
-        std::map<std::string, std::shared_ptr<State>> states;
+        auto tpl = std::make_shared<PieceTemplate>();
+        tpl->type = p_type;
+        tpl->transitions = _load_master_csv(piece_dir / "states");
         for (const auto& entry : std::filesystem::directory_iterator(piece_dir / "states")) {
             if (!entry.is_directory()) continue;
-            std::string name = entry.path().filename().string();
+            StateTemplate st;
+            st.name = entry.path().filename().string();
             auto cfg_path = entry.path() / "config.json";
             nlohmann::json cfg;
             if (std::filesystem::exists(cfg_path)) {
                 std::ifstream cfg_file(cfg_path);
                 cfg_file >> cfg;
             }
-            auto moves_path = entry.path() / "moves.txt";
-            std::shared_ptr<Moves> moves = std::filesystem::exists(moves_path) ? std::make_shared<Moves>(moves_path.string(), board_size) : nullptr;
-            // Always create a fresh graphics and physics pointer for each state
-            auto graphics_ptr = graphics_factory->load(entry.path() / "sprites", cfg.value("graphics", nlohmann::json::object()), cell_px);
-            auto physics_cfg = cfg.value("physics", nlohmann::json::object());
-            auto physics_ptr = physics_factory->create(cell, name, physics_cfg);
-            physics_ptr->do_i_need_clear_path = physics_cfg.value("need_clear_path", true);
-            auto st = std::make_shared<State>(
-                moves,
-                std::shared_ptr<Graphics>(std::move(graphics_ptr)),
+            st.physics_cfg = cfg.value("physics", nlohmann::json::object());
+            st.need_clear_path = st.physics_cfg.value("need_clear_path", true);
+            auto graphics_cfg = cfg.value("graphics", nlohmann::json::object());
+            st.loop = graphics_cfg.value("is_loop", true);
+            st.fps = static_cast<float>(graphics_cfg.value("frames_per_sec", 6.0));
+            // Rules are read once per piece type and shared by all its pieces
+            st.moves = MovesRegistry::instance().load(p_type, st.name, entry.path() / "moves.txt", board_size);
+            st.frames = sprite_atlas ? sprite_atlas->shared_frames(p_type, st.name) : nullptr;
+            if (!st.frames) {
+                // No atlas (or it skipped the state): decode the sprites here, once
+                st.frames = graphics_factory->load(entry.path() / "sprites", graphics_cfg, cell_px)->frames;
+            }
+            tpl->states.emplace(st.name, std::move(st));
+        }
+        tpl->compile_transitions();
+        _templates.emplace(p_type, tpl);
+        return tpl;
+    }
+
+    // Runtime state machine of one piece: per-state physics and animation
+    // timers, with config, moves and frames shared from the type's template.
+    // States are in template order, so tpl.index_of() indexes the result.
+    std::vector<std::unique_ptr<State>> _build_state_machine(const PieceTemplate& tpl, std::pair<int, int> cell) {
+        std::vector<std::unique_ptr<State>> states;
+        for (const auto& [name, st_tpl] : tpl.states) {
+            auto physics_ptr = physics_factory->create(cell, name, st_tpl.physics_cfg);
+            physics_ptr->do_i_need_clear_path = st_tpl.need_clear_path;
+            auto st = std::make_unique<State>(
+                st_tpl.moves,
+                std::make_shared<Graphics>(st_tpl.frames, st_tpl.loop, st_tpl.fps),
                 std::move(physics_ptr)
             );
+            st->id = st_tpl.id;
             st->name = name;
-            states[name] = st;
+            states.push_back(std::move(st));
         }
-        for (const auto& [frm, ev_map] : _global_trans) {
-            auto src = states.find(frm);
-            if (src == states.end()) continue;
-            for (const auto& [ev, nxt] : ev_map) {
-                auto dst = states.find(nxt);
-                if (dst == states.end()) continue;
-                src->second->set_transition(ev, dst->second);
+        // Each state gets its row of the template's [state][event] table
+        for (size_t s = 0; s < states.size(); ++s) {
+            for (EventId ev = 0; ev < tpl.event_count; ++ev) {
+                int nxt = tpl.next_state(static_cast<int>(s), ev);
+                if (nxt >= 0) states[s]->set_transition(ev, states[nxt].get());
             }
         }
         // Ensure all states' physics are initialized with the correct cell
-        for (auto& [name, st] : states) {
+        for (auto& st : states) {
             if (st && st->physics) {
-                std::vector<int> cell_vec{cell.first, cell.second};
-                // אם הפיזיקה היא MovePhysics, נאתחל עם שני וקטורים
+                // אם הפיזיקה היא MovePhysics, נאתחל עם שני תאים
                 if (dynamic_cast<MovePhysics*>(st->physics.get())) {
-                    Command init_cmd(0, "", "move", {cell_vec, cell_vec});
-                    st->reset(init_cmd);
+                    st->reset(TypedCommand::move(0, cell, cell));
                 } else {
-                    Command init_cmd(0, "", "idle", {cell_vec});
-                    st->reset(init_cmd);
+                    st->reset(TypedCommand::idle(0, cell));
                 }
             }
         }
-        auto it = states.find("idle");
-        return (it != states.end()) ? it->second : nullptr;
+        return states;
+    }
+
+    // Seeds a template built elsewhere (asset pack); get_template then never reads the type's directory.
+    void add_template(std::shared_ptr<const PieceTemplate> tpl) {
+        _templates[tpl->type] = std::move(tpl);
     }
 
     std::shared_ptr<Piece> create_piece(const std::string& p_type, std::pair<int, int> cell) {
-        auto p_dir = pieces_root / p_type;
         // Build a fresh state machine for each piece, and inject the initial cell
-        auto state = _build_state_machine(p_dir, cell);
-        auto piece = std::make_shared<Piece>(p_type + "_" + std::to_string(cell.first) + "," + std::to_string(cell.second), state);
+        const auto tpl = get_template(p_type);
+        auto states = _build_state_machine(*tpl, cell);
+        int idle = tpl->index_of(state_names().find("idle"));
+        State* state = idle >= 0 ? states[idle].get() : nullptr;
+        auto piece = std::make_shared<Piece>(p_type + "_" + std::to_string(cell.first) + "," + std::to_string(cell.second), std::move(states), state);
         // Pass the initial cell to the state/physics for correct initialization
         if (piece->state && piece->state->physics) {
-            std::vector<int> cell_vec{cell.first, cell.second};
             if (dynamic_cast<MovePhysics*>(piece->state->physics.get())) {
-                Command init_cmd(0, piece->id, "move", {cell_vec, cell_vec});
-                piece->state->reset(init_cmd);
+                piece->state->reset(TypedCommand::move(0, cell, cell));
             } else {
-                Command init_cmd(0, piece->id, "idle", {cell_vec});
-                piece->state->reset(init_cmd);
+                piece->state->reset(TypedCommand::idle(0, cell));
             }
         }
         return piece;
     }
+
+private:
+    std::map<std::string, std::shared_ptr<const PieceTemplate>> _templates;
 };
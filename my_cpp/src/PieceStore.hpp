@@ -0,0 +1,157 @@
+#pragma once
+#include "Bitboard.hpp"
+#include "NameInterner.hpp"
+#include "SlotMap.hpp"
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+class Piece;
+
+// Per-frame piece data as parallel arrays (structure of arrays), indexed by
+// PieceHandle - the piece's slot in Game::pieces. Slots are stable, so a
+// removed piece leaves a hole (valid = 0, piece = nullptr) and nobody moves. Passes that touch every
+// piece each frame (occupancy, drawing) walk these arrays instead of going
+// Piece -> State -> BasePhysics -> std::vector for every field.
+//
+// A piece attached to the store publishes its row whenever its state or
+// physics changes (Piece::update, Piece::on_command, Game's direct moves);
+// Piece keeps its API and reads back through the store.
+//
+// The store also keeps the board index: `occupancy` and the square of each
+// piece are updated only when a piece enters or leaves a cell, so cell ->
+// piece and piece -> cell are array reads instead of a rebuild per query.
+class PieceStore {
+public:
+    std::vector<float> row, col;         // position in cells (physics _curr_pos_m)
+    std::vector<float> vel_row, vel_col; // cells per second, 0 when not moving
+    std::vector<int32_t> start_ms;       // when the current state began
+    std::vector<StateId> state;
+    std::vector<PieceColor> color;       // Count when the id is not a piece code
+    std::vector<PieceType> type;
+    std::vector<uint8_t> valid;          // 0: no state/physics, row is meaningless
+    std::vector<Piece*> piece;           // back to the full object
+    std::vector<int8_t> square;          // square in `occupancy`, -1 when off the index
+    // Pieces on the board with a known type; a square shared by several
+    // pieces shows the first one that got there
+    Occupancy occupancy;
+
+    size_t size() const { return piece.size(); }
+
+    void clear() {
+        row.clear();
+        col.clear();
+        vel_row.clear();
+        vel_col.clear();
+        start_ms.clear();
+        state.clear();
+        color.clear();
+        type.clear();
+        valid.clear();
+        piece.clear();
+        square.clear();
+        _next.clear();
+        _first.fill(NO_PIECE);
+        occupancy.clear();
+    }
+
+    // Rebuilds the store from the piece slots; handles are slot numbers.
+    void assign(const SlotMap<std::shared_ptr<Piece>>& pieces) {
+        clear();
+        size_t n = pieces.slot_count();
+        row.resize(n);
+        col.resize(n);
+        vel_row.resize(n);
+        vel_col.resize(n);
+        start_ms.resize(n);
+        state.resize(n, NO_NAME);
+        color.resize(n, PieceColor::Count);
+        type.resize(n, PieceType::Count);
+        valid.resize(n, 0);
+        piece.resize(n, nullptr);
+        square.resize(n, -1);
+        _next.resize(n, NO_PIECE);
+        for (size_t i = 0; i < n; ++i) {
+            piece[i] = pieces.alive(i) ? pieces[i].get() : nullptr;
+            if (piece[i]) _attach(piece[i], static_cast<PieceHandle>(i));
+        }
+    }
+
+    // Empties h's row and takes it off the board index (the piece was removed)
+    void detach(PieceHandle h) {
+        if (h >= size()) return;
+        _unlink(h);
+        valid[h] = 0;
+        piece[h] = nullptr;
+    }
+
+    // Copies piece h's state and physics into its row (Piece.cpp).
+    void sync(PieceHandle h);
+
+    // True while `p` is the piece stored at h (a removed piece keeps its
+    // old handle until the store is rebuilt).
+    bool holds(PieceHandle h, const Piece* p) const { return h < piece.size() && piece[h] == p; }
+
+    std::pair<int, int> cell(PieceHandle h) const {
+        return {static_cast<int>(std::lround(row[h])), static_cast<int>(std::lround(col[h]))};
+    }
+
+    // First piece on the cell, NO_PIECE when empty; next_at() walks the rest
+    PieceHandle piece_at(std::pair<int, int> cell_) const {
+        return on_board(cell_.first, cell_.second) ? _first[square_of(cell_)] : NO_PIECE;
+    }
+    PieceHandle next_at(PieceHandle h) const { return _next[h]; }
+
+    // Re-indexes pieces whose row/col were written in place (MoveBatch::integrate)
+    void relocate(const std::vector<PieceHandle>& handles) {
+        for (PieceHandle h : handles) _reindex(h, false);
+    }
+
+private:
+    std::array<PieceHandle, SQUARE_COUNT> _first = _no_pieces();
+    std::vector<PieceHandle> _next; // next piece on the same square
+
+    static std::array<PieceHandle, SQUARE_COUNT> _no_pieces() {
+        std::array<PieceHandle, SQUARE_COUNT> a;
+        a.fill(NO_PIECE);
+        return a;
+    }
+
+    void _attach(Piece* p, PieceHandle h);
+
+    // Moves h in the index when its cell changed, or its color/type did
+    void _reindex(PieceHandle h, bool kind_changed) {
+        int sq = -1;
+        if (valid[h] && type[h] != PieceType::Count) {
+            auto c = cell(h);
+            if (on_board(c.first, c.second)) sq = square_of(c);
+        }
+        if (sq == square[h] && !kind_changed) return;
+        _unlink(h);
+        if (sq >= 0) _link(h, sq);
+    }
+
+    void _link(PieceHandle h, int sq) {
+        square[h] = static_cast<int8_t>(sq);
+        _next[h] = NO_PIECE;
+        PieceHandle* link = &_first[sq];
+        while (*link != NO_PIECE) link = &_next[*link];
+        *link = h;
+        occupancy.place(sq, h, color[h], type[h]);
+    }
+
+    // The square's bits are rebuilt from the pieces left on it (usually none)
+    void _unlink(PieceHandle h) {
+        int sq = square[h];
+        if (sq < 0) return;
+        square[h] = -1;
+        PieceHandle* link = &_first[sq];
+        while (*link != h) link = &_next[*link];
+        *link = _next[h];
+        _next[h] = NO_PIECE;
+        occupancy.remove(sq);
+        for (PieceHandle o = _first[sq]; o != NO_PIECE; o = _next[o]) occupancy.place(sq, o, color[o], type[o]);
+    }
+};
@@ -0,0 +1,71 @@
+#pragma once
+#include "Img.hpp"
+#include "Moves.hpp"
+#include "NameInterner.hpp"
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+#include <nlohmann/json.hpp>
+
+// Everything about a piece type that does not change during a game: its
+// states with their config, move rules and sprite frames, and the transition
+// table. Built once per type by PieceFactory and shared (read-only) by all
+// pieces of that type; a piece only adds its own physics and animation timers.
+struct StateTemplate {
+    std::string name;
+    StateId id = NO_NAME;
+    nlohmann::json physics_cfg;
+    bool need_clear_path = true;
+    bool loop = true;
+    float fps = 6.0f;
+    std::shared_ptr<const Moves> moves;
+    std::shared_ptr<const std::vector<Img>> frames;
+};
+
+struct PieceTemplate {
+    std::string type;
+    std::map<std::string, StateTemplate> states;
+    std::map<std::string, std::map<std::string, std::string>> transitions; // from -> event -> to
+
+    // Filled by compile_transitions(). States are numbered in `states` order;
+    // the table is [state index][event id] -> state index, -1 = no transition.
+    std::vector<StateId> state_ids;
+    size_t event_count = 0;
+    std::vector<int16_t> transition_table;
+
+    // Interns the state and event names and builds the flat table.
+    // Call after `states` and `transitions` are complete.
+    void compile_transitions() {
+        state_ids.clear();
+        for (auto& [name, st] : states) {
+            st.id = state_names().intern(name);
+            state_ids.push_back(st.id);
+        }
+        for (const auto& [from, events] : transitions)
+            for (const auto& [event, to] : events) event_names().intern(event);
+        event_count = event_names().size();
+        transition_table.assign(state_ids.size() * event_count, -1);
+        for (const auto& [from, events] : transitions) {
+            int src = index_of(state_names().find(from));
+            if (src < 0) continue;
+            for (const auto& [event, to] : events) {
+                int dst = index_of(state_names().find(to));
+                if (dst >= 0) transition_table[src * event_count + event_names().find(event)] = static_cast<int16_t>(dst);
+            }
+        }
+    }
+
+    // Index of the state in this type's table, -1 if the type has no such state
+    int index_of(StateId id) const {
+        for (size_t i = 0; i < state_ids.size(); ++i)
+            if (state_ids[i] == id) return static_cast<int>(i);
+        return -1;
+    }
+
+    int next_state(int state_index, EventId event) const {
+        if (event >= event_count) return -1;
+        return transition_table[state_index * event_count + event];
+    }
+};
@@ -0,0 +1,127 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <utility>
+#include <vector>
+
+// Reference to a SlotMap entry: the slot plus the slot's generation when the
+// key was handed out. Removing the entry bumps the generation, so an old key
+// stops resolving instead of reaching whatever reuses the slot.
+struct SlotKey {
+    static constexpr uint16_t NO_SLOT = 0xFFFF;
+    uint16_t slot = NO_SLOT;
+    uint16_t generation = 0;
+
+    bool empty() const { return slot == NO_SLOT; }
+    friend bool operator==(SlotKey a, SlotKey b) { return a.slot == b.slot && a.generation == b.generation; }
+    friend bool operator!=(SlotKey a, SlotKey b) { return !(a == b); }
+};
+
+// Values in stable slots: insert and erase are O(1) (a freed slot goes on a
+// free list and is reused by the next insert), nothing else moves when an
+// entry is removed, and iteration visits the live entries in slot order.
+// Slot numbers double as indices into parallel arrays (PieceStore, ...).
+template <typename T>
+class SlotMap {
+public:
+    SlotKey insert(T value) {
+        uint16_t slot;
+        if (!_free.empty()) {
+            slot = _free.back();
+            _free.pop_back();
+            _values[slot] = std::move(value);
+        } else {
+            slot = static_cast<uint16_t>(_values.size());
+            _values.push_back(std::move(value));
+            _generation.push_back(0);
+            _live.push_back(0);
+        }
+        _live[slot] = 1;
+        ++_size;
+        return {slot, _generation[slot]};
+    }
+
+    // False when the key is stale or empty
+    bool erase(SlotKey key) {
+        if (!contains(key)) return false;
+        _values[key.slot] = T{};
+        _live[key.slot] = 0;
+        ++_generation[key.slot];
+        _free.push_back(key.slot);
+        --_size;
+        return true;
+    }
+
+    bool contains(SlotKey key) const {
+        return key.slot < _values.size() && _live[key.slot] && _generation[key.slot] == key.generation;
+    }
+
+    // nullptr when the key is stale
+    T* get(SlotKey key) { return contains(key) ? &_values[key.slot] : nullptr; }
+    const T* get(SlotKey key) const { return contains(key) ? &_values[key.slot] : nullptr; }
+
+    bool alive(size_t slot) const { return slot < _values.size() && _live[slot]; }
+    // Current key of a slot, empty when the slot is free
+    SlotKey key_of(size_t slot) const {
+        return alive(slot) ? SlotKey{static_cast<uint16_t>(slot), _generation[slot]} : SlotKey{};
+    }
+
+    // By slot, for code holding a slot it got this frame; T{} when free
+    T& operator[](size_t slot) { return _values[slot]; }
+    const T& operator[](size_t slot) const { return _values[slot]; }
+
+    size_t size() const { return _size; }
+    bool empty() const { return _size == 0; }
+    // One past the highest slot ever used: the size parallel arrays need
+    size_t slot_count() const { return _values.size(); }
+
+    void clear() {
+        for (size_t i = 0; i < _values.size(); ++i) {
+            if (_live[i]) erase(key_of(i));
+        }
+    }
+
+    template <typename V, typename Map>
+    class basic_iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+        using pointer = V*;
+        using reference = V&;
+
+        basic_iterator(Map* map, size_t slot) : _map(map), _slot(slot) { _skip(); }
+        reference operator*() const { return _map->_values[_slot]; }
+        pointer operator->() const { return &_map->_values[_slot]; }
+        basic_iterator& operator++() {
+            ++_slot;
+            _skip();
+            return *this;
+        }
+        bool operator==(const basic_iterator& o) const { return _slot == o._slot; }
+        bool operator!=(const basic_iterator& o) const { return _slot != o._slot; }
+        size_t slot() const { return _slot; }
+
+    private:
+        Map* _map;
+        size_t _slot;
+        void _skip() {
+            while (_slot < _map->_values.size() && !_map->_live[_slot]) ++_slot;
+        }
+    };
+    using iterator = basic_iterator<T, SlotMap>;
+    using const_iterator = basic_iterator<const T, const SlotMap>;
+
+    iterator begin() { return iterator(this, 0); }
+    iterator end() { return iterator(this, _values.size()); }
+    const_iterator begin() const { return const_iterator(this, 0); }
+    const_iterator end() const { return const_iterator(this, _values.size()); }
+
+private:
+    std::vector<T> _values;
+    std::vector<uint16_t> _generation;
+    std::vector<uint8_t> _live;
+    std::vector<uint16_t> _free;
+    size_t _size = 0;
+};
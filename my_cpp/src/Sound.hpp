@@ -1,6 +1,7 @@
 #pragma once
 #include <SDL.h>
 #include <SDL_mixer.h>
+#include "Log.hpp"
 #include <string>
 #include <iostream>
 
@@ -11,10 +12,10 @@ public:
     // בנאי - אתחול SDL ו-SDL_mixer
     Sound() : _sound(nullptr) {
         if (SDL_Init(SDL_INIT_AUDIO) < 0) {
-            std::cout << "error in SDL_Init: " << SDL_GetError() << std::endl;
+            KFC_ERROR(Sound, "error in SDL_Init: " << SDL_GetError());
         }
         if (Mix_OpenAudio(22050, MIX_DEFAULT_FORMAT, 2, 4096) < 0) {
-            std::cout << "error in Mix_OpenAudio: " << Mix_GetError() << std::endl;
+            KFC_ERROR(Sound, "error in Mix_OpenAudio: " << Mix_GetError());
         }
     }
 
@@ -37,8 +38,21 @@ public:
         }
         _sound = Mix_LoadWAV(sound_file.c_str());
         if (!_sound) {
-            std::cout << "[ERROR] Failed to load sound file: " << sound_file << std::endl;
-            std::cout << "[ERROR] Mix_LoadWAV: " << Mix_GetError() << std::endl;
+            KFC_ERROR(Sound, "Failed to load sound file: " << sound_file << " (Mix_LoadWAV: " << Mix_GetError() << ")");
+            return;
+        }
+        Mix_PlayChannel(-1, _sound, 0);
+    }
+
+    // ניגון קול שכבר נמצא בזיכרון (קובץ WAV מתוך asset pack)
+    void play_memory(const void* data, size_t size) {
+        if (_sound) {
+            Mix_FreeChunk(_sound);
+            _sound = nullptr;
+        }
+        _sound = Mix_LoadWAV_RW(SDL_RWFromConstMem(data, static_cast<int>(size)), 1);
+        if (!_sound) {
+            KFC_ERROR(Sound, "Mix_LoadWAV_RW: " << Mix_GetError());
             return;
         }
         Mix_PlayChannel(-1, _sound, 0);
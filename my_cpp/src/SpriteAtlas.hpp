@@ -0,0 +1,164 @@
+#pragma once
+#include "Img.hpp"
+#include "WorkerPool.hpp"
+#include <atomic>
+#include <chrono>
+#include <algorithm>
+#include <filesystem>
+#include <functional>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+// Wall time of each startup stage. decode/resize are summed over all workers,
+// so they can exceed decode_stage_ms, the wall time of the parallel stage.
+struct AssetLoadTimings {
+    size_t files = 0;
+    size_t workers = 1;
+    double scan_ms = 0.0;
+    double decode_ms = 0.0;
+    double resize_ms = 0.0;
+    double decode_stage_ms = 0.0;
+    double assemble_ms = 0.0; // publishing frames; GameFactory adds piece assembly
+
+    // One line for the startup report; shared by the game's log and pack_assets
+    std::string to_string() const {
+        std::ostringstream os;
+        os << files << " sprites on " << workers << " workers: scan " << scan_ms << " ms, decode " << decode_ms
+           << " ms, resize " << resize_ms << " ms (cpu; stage wall " << decode_stage_ms << " ms), assemble "
+           << assemble_ms << " ms";
+        return os.str();
+    }
+};
+
+// All sprite frames under <pieces_root>/<type>/states/<state>/sprites, decoded
+// and scaled to the cell size once at startup. Lookups never touch the disk.
+class SpriteAtlas {
+public:
+    // nullptr = built-in Img decode + resize
+    using ImgLoader = std::function<Img(const std::filesystem::path&, std::pair<int, int>, bool)>;
+    using FramesHandle = std::shared_ptr<const std::vector<Img>>;
+    using StateFrames = std::map<std::string, FramesHandle, std::less<>>;
+
+    std::pair<int, int> cell_size;
+
+    SpriteAtlas() : cell_size(0, 0) {}
+
+    // Loads in three stages: scan the tree for sprite files, decode and resize
+    // them (on `pool` when given), then publish the frames per type/state.
+    void load(const std::filesystem::path& pieces_root, std::pair<int, int> cell_size_, const ImgLoader& loader,
+              WorkerPool* pool = nullptr, AssetLoadTimings* timings = nullptr) {
+        using steady = std::chrono::steady_clock;
+        auto ms_since = [](steady::time_point t0) {
+            return std::chrono::duration<double, std::milli>(steady::now() - t0).count();
+        };
+        AssetLoadTimings local;
+        AssetLoadTimings& t = timings ? *timings : local;
+        t.workers = pool ? pool->size() : 1;
+        cell_size = cell_size_;
+        _frames.clear();
+        if (!std::filesystem::exists(pieces_root)) return;
+
+        auto t0 = steady::now();
+        struct Job {
+            std::filesystem::path file;
+            std::string type, state;
+        };
+        std::vector<Job> jobs;
+        for (const auto& piece_dir : std::filesystem::directory_iterator(pieces_root)) {
+            auto states_dir = piece_dir.path() / "states";
+            if (!piece_dir.is_directory() || !std::filesystem::exists(states_dir)) continue;
+            std::string piece_type = piece_dir.path().filename().string();
+            for (const auto& state_dir : std::filesystem::directory_iterator(states_dir)) {
+                auto sprites_dir = state_dir.path() / "sprites";
+                if (!state_dir.is_directory() || !std::filesystem::exists(sprites_dir)) continue;
+                // Same ordering as Graphics::_load_sprites so frame indices agree
+                std::vector<std::filesystem::path> files;
+                for (const auto& f : std::filesystem::directory_iterator(sprites_dir)) {
+                    if (f.path().extension() == ".png") files.push_back(f.path());
+                }
+                std::sort(files.begin(), files.end());
+                std::string state = state_dir.path().filename().string();
+                _frames[piece_type][state] = nullptr;
+                for (auto& f : files) jobs.push_back({std::move(f), piece_type, state});
+            }
+        }
+        t.files = jobs.size();
+        t.scan_ms = ms_since(t0);
+
+        t0 = steady::now();
+        std::vector<Img> decoded(jobs.size());
+        std::atomic<int64_t> decode_ns{0}, resize_ns{0};
+        auto decode_one = [&](size_t i) {
+            auto d0 = steady::now();
+            if (loader) {
+                decoded[i] = loader(jobs[i].file, cell_size, false);
+                decode_ns += std::chrono::duration_cast<std::chrono::nanoseconds>(steady::now() - d0).count();
+                return;
+            }
+            decoded[i].decode(jobs[i].file.string());
+            auto d1 = steady::now();
+            decoded[i].resize_to(cell_size, false, cv::INTER_AREA, jobs[i].file.string());
+            decode_ns += std::chrono::duration_cast<std::chrono::nanoseconds>(d1 - d0).count();
+            resize_ns += std::chrono::duration_cast<std::chrono::nanoseconds>(steady::now() - d1).count();
+        };
+        if (pool) {
+            pool->parallel_for(jobs.size(), decode_one);
+        } else {
+            for (size_t i = 0; i < jobs.size(); ++i) decode_one(i);
+        }
+        t.decode_stage_ms = ms_since(t0);
+        t.decode_ms = decode_ns.load() / 1e6;
+        t.resize_ms = resize_ns.load() / 1e6;
+
+        t0 = steady::now();
+        std::map<std::pair<std::string, std::string>, std::shared_ptr<std::vector<Img>>> building;
+        for (size_t i = 0; i < jobs.size(); ++i) {
+            auto& frames = building[{jobs[i].type, jobs[i].state}];
+            if (!frames) frames = std::make_shared<std::vector<Img>>();
+            frames->push_back(std::move(decoded[i]));
+        }
+        for (auto& [key, frames] : building) _frames[key.first][key.second] = std::move(frames);
+        t.assemble_ms = ms_since(t0);
+    }
+
+    // Frames that are already decoded and scaled (asset pack).
+    void add(const std::string& piece_type, const std::string& state, FramesHandle frames) {
+        _frames[piece_type][state] = std::move(frames);
+    }
+
+    const std::vector<Img>* frames(std::string_view piece_type, std::string_view state) const {
+        return shared_frames(piece_type, state).get();
+    }
+
+    // Same frames as a shared handle, for owners that outlive a lookup (Graphics).
+    FramesHandle shared_frames(std::string_view piece_type, std::string_view state) const {
+        auto p = _frames.find(piece_type);
+        if (p == _frames.end()) return nullptr;
+        auto s = p->second.find(state);
+        if (s == p->second.end() || !s->second || s->second->empty()) return nullptr;
+        return s->second;
+    }
+
+    // Frame index wraps around the state's frame count.
+    const Img* frame(std::string_view piece_type, std::string_view state, int index) const {
+        auto f = frames(piece_type, state);
+        if (!f) return nullptr;
+        int n = static_cast<int>(f->size());
+        return &(*f)[((index % n) + n) % n];
+    }
+
+    size_t frame_count() const {
+        size_t n = 0;
+        for (const auto& [type, states] : _frames)
+            for (const auto& [state, frames] : states) n += frames ? frames->size() : 0;
+        return n;
+    }
+
+private:
+    std::map<std::string, StateFrames, std::less<>> _frames;
+};
@@ -1,8 +1,12 @@
 #pragma once
 #include "Command.hpp"
+#include "Faults.hpp"
+#include "Log.hpp"
 #include "Graphics.hpp"
 #include "Moves.hpp"
+#include "NameInterner.hpp"
 #include "Physics.hpp"
+#include <vector>
 #include <iostream>
 #include <map>
 #include <memory>
@@ -17,13 +21,16 @@ class State {
   State& operator=(State&&) = delete;
 public:
   virtual ~State() = default;
-  std::shared_ptr<Moves> moves;
+  std::shared_ptr<const Moves> moves; // shared per piece type, see MovesRegistry
   std::shared_ptr<Graphics> graphics;
   std::unique_ptr<BasePhysics> physics;
-  std::map<std::string, std::shared_ptr<State>> transitions;
-  std::string name;
+  // This state's row of the type's transition table, indexed by EventId.
+  // Non-owning: the piece owns all of its states (Piece::states).
+  std::vector<State *> transitions;
+  StateId id = NO_NAME;
+  std::string name; // state_names().name(id), kept for logs
 
-  State(std::shared_ptr<Moves> moves_, std::shared_ptr<Graphics> graphics_,
+  State(std::shared_ptr<const Moves> moves_, std::shared_ptr<Graphics> graphics_,
         std::unique_ptr<BasePhysics> physics_)
       : moves(std::move(moves_)), graphics(std::move(graphics_)), physics(std::move(physics_)), name("") {
     if (physics) {
@@ -33,69 +40,88 @@ public:
 
   std::string repr() const { return "State(" + name + ")"; }
 
-  void set_transition(const std::string &event, std::shared_ptr<State> target) {
+  void set_transition(EventId event, State *target) {
+    if (event >= transitions.size()) transitions.resize(event + 1, nullptr);
     transitions[event] = target;
   }
 
+  void set_transition(const std::string &event, State *target) {
+    set_transition(event_names().intern(event), target);
+  }
+
 
-  bool reset(const Command &cmd) {
+  bool reset(const TypedCommand &cmd) {
     graphics->reset(cmd);
     return physics->reset(cmd);
   }
 
+  bool reset(const Command &cmd) { return reset(to_typed(cmd)); }
+
 
   // Overload for on_command with 2 arguments (for update)
-  std::pair<std::shared_ptr<State>, bool> on_command(
+  std::pair<State *, bool> on_command(
       const Command &cmd,
       const std::map<std::pair<int, int>, std::vector<std::shared_ptr<Piece>>> *cell2piece) {
-    return on_command(cmd, cell2piece, "");
+    return on_command(cmd, cell2piece, PieceColor::Count);
   }
 
-  std::pair<std::shared_ptr<State>, bool> on_command(
+  std::pair<State *, bool> on_command(
       const Command &cmd,
       const std::map<std::pair<int, int>, std::vector<std::shared_ptr<Piece>>>
           *cell2piece,
-      const std::string &my_color) {
-    auto it = transitions.find(cmd.type);
-    if (it == transitions.end()) {
-      return std::make_pair(std::shared_ptr<State>(this), false);
+      PieceColor my_color) {
+    if (!cell2piece) return on_command(cmd, static_cast<const Occupancy *>(nullptr), my_color);
+    Occupancy occ = Occupancy::from_cell_map(*cell2piece);
+    return on_command(cmd, &occ, my_color);
+  }
+
+  std::pair<State *, bool> on_command(
+      const Command &cmd, const Occupancy *occ, PieceColor my_color) {
+    return on_command(to_typed(cmd), occ, my_color);
+  }
+
+  // A malformed move leaves the state as it is and reports why in `fault`
+  std::pair<State *, bool> on_command(
+      const TypedCommand &cmd, const Occupancy *occ, PieceColor my_color,
+      Fault *fault = nullptr) {
+    EventId event = event_id(cmd.kind);
+    if (event >= transitions.size() || !transitions[event]) {
+      return std::make_pair(this, false);
     }
-    auto nxt = it->second;
-    if (cmd.type == "move") {
-      if (!moves || cmd.params.size() < 2) {
-        throw std::runtime_error("Invalid move command");
+    State *nxt = transitions[event];
+    if (cmd.kind == EventKind::Move) {
+      if (!moves || cmd.cell_count < 2) {
+        if (fault) *fault = Fault::BadMoveCommand;
+        return std::make_pair(this, false);
       }
-      auto src_cell = std::any_cast<std::pair<int, int>>(cmd.params[0]);
-      auto dst_cell = std::any_cast<std::pair<int, int>>(cmd.params[1]);
+      auto src_cell = cmd.src.pair();
+      auto dst_cell = cmd.dst.pair();
       if (src_cell != physics->get_curr_cell()) {
-        throw std::runtime_error("source cell is not the current cell");
+        if (fault) *fault = Fault::WrongSourceCell;
+        return std::make_pair(this, false);
       }
-      if (!moves->is_valid(
-              src_cell, dst_cell,
-              cell2piece ? *cell2piece
-                         : std::map<std::pair<int, int>,
-                                    std::vector<std::shared_ptr<Piece>>>(),
-              physics->is_need_clear_path(), my_color)) {
-        std::cout << "Invalid move: (" << src_cell.first << ","
+      if (!moves->is_valid(src_cell, dst_cell, occ ? *occ : Occupancy(),
+                           physics->is_need_clear_path(), my_color)) {
+        KFC_INFO(Moves, "Invalid move: (" << src_cell.first << ","
                   << src_cell.second << ") -> (" << dst_cell.first << ","
-                  << dst_cell.second << ")" << std::endl;
-        return std::make_pair(std::shared_ptr<State>(this), false);
+                  << dst_cell.second << ")");
+        return std::make_pair(this, false);
       }
     }
-    std::cout << "[TRANSITION] " << cmd.type << ": " << repr() << " ? "
-              << nxt->repr() << std::endl;
+    KFC_DEBUG(State, event_name(cmd.kind) << ": " << name << " -> " << nxt->name);
     bool flag = nxt->reset(cmd);
+    if (fault && nxt->physics && nxt->physics->fault != Fault::None) *fault = nxt->physics->fault;
     return std::make_pair(nxt, flag);
   }
 
-  std::pair<std::shared_ptr<State>, bool> update(int now_ms) {
+  std::pair<State *, bool> update(int now_ms) {
     auto internal = physics->update(now_ms);
     if (internal) {
-      std::cout << "[DBG] internal: " << internal->type << std::endl;
-      return on_command(*internal, nullptr);
+      KFC_TRACE(State, "internal: " << event_name(internal->kind));
+      return on_command(*internal, nullptr, PieceColor::Count);
     }
     graphics->update(now_ms);
-    return std::make_pair(std::shared_ptr<State>(this), false);
+    return std::make_pair(this, false);
   }
 
   bool can_be_captured() const { return physics->can_be_captured(); }
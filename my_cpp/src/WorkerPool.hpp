@@ -0,0 +1,98 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed set of worker threads for startup batch work. parallel_for() hands
+// out indices [0, count) one at a time (tasks like PNG decodes vary a lot in
+// cost) and returns when all are done; the calling thread works too. The
+// first exception thrown by a task is rethrown on the caller.
+class WorkerPool {
+public:
+    // 0 = one thread per hardware thread
+    explicit WorkerPool(size_t threads = 0) {
+        if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+        // the caller is one of the workers
+        for (size_t i = 1; i < threads; ++i) _threads.emplace_back([this] { _worker(); });
+    }
+
+    ~WorkerPool() {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _stop = true;
+        }
+        _wake.notify_all();
+        for (auto& t : _threads) t.join();
+    }
+
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    size_t size() const { return _threads.size() + 1; }
+
+    void parallel_for(size_t count, const std::function<void(size_t)>& fn) {
+        if (count == 0) return;
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _fn = &fn;
+            _count = count;
+            _next = 0;
+            _active = _threads.size();
+            _error = nullptr;
+            ++_generation;
+        }
+        _wake.notify_all();
+        _run_tasks();
+        std::unique_lock<std::mutex> lock(_mutex);
+        _done.wait(lock, [this] { return _active == 0; });
+        _fn = nullptr;
+        if (_error) std::rethrow_exception(_error);
+    }
+
+private:
+    std::vector<std::thread> _threads;
+    std::mutex _mutex;
+    std::condition_variable _wake, _done;
+    const std::function<void(size_t)>* _fn = nullptr;
+    size_t _count = 0;
+    std::atomic<size_t> _next{0};
+    size_t _active = 0;
+    size_t _generation = 0;
+    bool _stop = false;
+    std::exception_ptr _error;
+
+    void _run_tasks() {
+        for (size_t i = _next++; i < _count; i = _next++) {
+            try {
+                (*_fn)(i);
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(_mutex);
+                if (!_error) _error = std::current_exception();
+            }
+        }
+    }
+
+    void _worker() {
+        size_t seen = 0;
+        for (;;) {
+            {
+                std::unique_lock<std::mutex> lock(_mutex);
+                _wake.wait(lock, [&] { return _stop || _generation != seen; });
+                if (_stop) return;
+                seen = _generation;
+            }
+            _run_tasks();
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                --_active;
+            }
+            _done.notify_one();
+        }
+    }
+};
@@ -7,11 +7,26 @@
 int main(int argc, char* argv[]) {
     std::cout << "Starting chess game..." << std::endl;
     auto imgFactory = ImgFactory();
-    auto game = create_game("../../pieces", imgFactory);
+    // assets.pack is rebuilt with the game whenever pieces/, pic/ or sounds/
+    // change (CMakeLists.txt passes its path); fall back to the raw asset tree
+    // without it
+#ifndef KFC_ASSET_PACK
+#define KFC_ASSET_PACK "../../assets.pack"
+#endif
+    const std::filesystem::path pack_path = KFC_ASSET_PACK;
+    std::shared_ptr<Game> game;
+    if (std::filesystem::exists(pack_path)) {
+        try {
+            game = create_game_from_pack(AssetPack::open(pack_path));
+        } catch (const std::exception& ex) {
+            KFC_WARN(Game, "Cannot use assets.pack (" << ex.what() << ") - loading the asset tree");
+        }
+    }
+    if (!game) game = create_game("../../pieces", imgFactory);
     std::cout << "Game created successfully" << std::endl;
 
     // Load and show start image
-    cv::Mat img = cv::imread("../../pic/start.png");
+    cv::Mat img = game->asset_pack ? game->asset_pack->image("pic/start.png").img : cv::imread("../../pic/start.png");
     if (!img.empty()) {
         int game_width = 768 + (2 * 300);
         int game_height = 768;
@@ -0,0 +1,141 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include "doctest/doctest.h"
+#include "CellTimeline.hpp"
+
+namespace {
+
+constexpr int64_t FOREVER = CellTimeline::FOREVER;
+
+// A piece standing on a cell from `from_ms` on
+std::vector<CellSpan> standing(int row, int col, int64_t from_ms = 0, bool capturable = true) {
+    return {{static_cast<int8_t>(row), static_cast<int8_t>(col), from_ms, FOREVER, capturable}};
+}
+
+// A straight move as Game::_track reserves it: the swept cells, then the
+// end cell from arrival on
+std::vector<CellSpan> moving(std::pair<int, int> src, std::pair<int, int> dst, float speed, int64_t start_ms,
+                             int64_t arrive_ms) {
+    std::vector<CellSpan> spans;
+    CellTimeline::trace_line(src, dst, speed, start_ms, arrive_ms, false, spans);
+    spans.push_back({static_cast<int8_t>(dst.first), static_cast<int8_t>(dst.second), arrive_ms, FOREVER, true});
+    return spans;
+}
+
+} // namespace
+
+TEST_CASE("trace_line switches cells at the half-cell lines") {
+    std::vector<CellSpan> spans;
+    CellTimeline::trace_line({0, 0}, {0, 3}, 1.0f, 1000, 4000, false, spans);
+    REQUIRE(spans.size() == 4);
+    CHECK(spans[0].col == 0);
+    CHECK(spans[0].enter_ms == 1000);
+    CHECK(spans[0].leave_ms == 1500);
+    CHECK(spans[1].col == 1);
+    CHECK(spans[1].enter_ms == 1500);
+    CHECK(spans[1].leave_ms == 2500);
+    CHECK(spans[2].col == 2);
+    CHECK(spans[2].leave_ms == 3500);
+    CHECK(spans[3].col == 3);
+    CHECK(spans[3].enter_ms == 3500);
+    CHECK(spans[3].leave_ms == 4000);
+}
+
+TEST_CASE("a piece crossing an occupied cell meets its occupant when it rounds into it") {
+    CellTimeline t;
+    t.reserve(1, standing(0, 2));
+    t.reserve(0, moving({0, 0}, {0, 4}, 1.0f, 0, 4000));
+
+    CHECK(t.next_ms() == 1500);
+    Encounter e;
+    REQUIRE(t.pop(e));
+    CHECK(e.at_ms == 1500);
+    CHECK(e.row == 0);
+    CHECK(e.col == 2);
+    CHECK(e.attacker == 0);
+    CHECK(e.occupant == 1);
+    CHECK_FALSE(t.pop(e));
+}
+
+TEST_CASE("a crossing between two frames is still found") {
+    // Fast enough to be in and out of (0,1) within 100 ms
+    CellTimeline t;
+    t.reserve(1, standing(0, 1));
+    t.reserve(0, moving({0, 0}, {0, 2}, 20.0f, 0, 100));
+    Encounter e;
+    REQUIRE(t.pop(e));
+    CHECK(e.col == 1);
+    CHECK(e.at_ms == 25);
+}
+
+TEST_CASE("encounters come out in time order") {
+    CellTimeline t;
+    t.reserve(1, standing(0, 3));
+    t.reserve(2, standing(0, 1));
+    t.reserve(0, moving({0, 0}, {0, 4}, 1.0f, 0, 4000));
+    Encounter first, second;
+    REQUIRE(t.pop(first));
+    REQUIRE(t.pop(second));
+    CHECK(first.occupant == 2);
+    CHECK(first.at_ms == 500);
+    CHECK(second.occupant == 1);
+    CHECK(second.at_ms == 2500);
+}
+
+TEST_CASE("pieces arriving at the same time do not take each other") {
+    CellTimeline t;
+    t.reserve(0, moving({0, 0}, {0, 2}, 1.0f, 0, 2000));
+    t.reserve(1, moving({0, 4}, {0, 2}, 1.0f, 0, 2000));
+    // Both round into (0,2) at 1500 ms
+    CHECK(t.next_ms() == FOREVER);
+}
+
+TEST_CASE("an occupant that cannot be captured is not met") {
+    CellTimeline t;
+    t.reserve(1, standing(0, 2, 0, false));
+    t.reserve(0, moving({0, 0}, {0, 4}, 1.0f, 0, 4000));
+    CHECK(t.next_ms() == FOREVER);
+}
+
+TEST_CASE("a knight only holds its destination") {
+    std::vector<CellSpan> jump = moving({0, 0}, {2, 1}, 1.0f, 0, 2236);
+    // As Game::_track does for pieces that need no clear path: keep the
+    // travel's last cell and the stay after arrival
+    jump.erase(jump.begin(), jump.end() - 2);
+    REQUIRE(jump.size() == 2);
+    CHECK(jump[0].row == 2);
+    CHECK(jump[0].col == 1);
+
+    CellTimeline t;
+    t.reserve(1, standing(1, 0));
+    t.reserve(2, standing(1, 1));
+    t.reserve(3, standing(2, 1));
+    t.reserve(0, jump);
+    Encounter e;
+    REQUIRE(t.pop(e));
+    CHECK(e.occupant == 3);
+    CHECK(e.at_ms == jump[0].enter_ms);
+    // Game removes the captured piece, which also drops the pair's second
+    // overlap (the knight's stay after landing)
+    t.release(e.occupant);
+    CHECK_FALSE(t.pop(e));
+}
+
+TEST_CASE("replacing or releasing a piece's spans drops its pending encounters") {
+    CellTimeline t;
+    t.reserve(1, standing(0, 2));
+    t.reserve(0, moving({0, 0}, {0, 4}, 1.0f, 0, 4000));
+    REQUIRE(t.next_ms() == 1500);
+
+    // The mover stops at (0,1) instead
+    t.reserve(0, standing(0, 1, 1000));
+    CHECK(t.next_ms() == FOREVER);
+
+    t.reserve(0, moving({0, 1}, {0, 3}, 1.0f, 2000, 4000));
+    CHECK(t.next_ms() == 2500);
+    t.release(1);
+    CHECK(t.next_ms() == FOREVER);
+
+    // A released piece can reserve again
+    t.reserve(1, standing(0, 2, 0));
+    CHECK(t.next_ms() == 2500);
+}
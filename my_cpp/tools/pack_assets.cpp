@@ -0,0 +1,101 @@
+// Builds the asset pack that create_game_from_pack maps at startup: sprites
+// decoded and scaled to CELL_PX, move tables compiled, configs and
+// transitions parsed, pictures decoded, sounds stored as-is.
+//   pack_assets <pieces_dir> <pic_dir> <sounds_dir> <output.pack>
+#include "AssetPack.hpp"
+#include "GameFactory.hpp"
+#include "WorkerPool.hpp"
+#include <algorithm>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+static std::vector<fs::path> files_with_extension(const fs::path& dir, const std::string& ext) {
+    std::vector<fs::path> files;
+    if (!fs::exists(dir)) return files;
+    for (const auto& f : fs::directory_iterator(dir)) {
+        if (f.is_regular_file() && f.path().extension() == ext) files.push_back(f.path());
+    }
+    std::sort(files.begin(), files.end());
+    return files;
+}
+
+static std::vector<std::vector<std::string>> read_layout(const fs::path& board_csv) {
+    std::vector<std::vector<std::string>> rows;
+    std::ifstream f(board_csv);
+    std::string line;
+    while (std::getline(f, line)) {
+        std::istringstream iss(line);
+        std::string code;
+        std::vector<std::string> row;
+        while (std::getline(iss, code, ',')) row.push_back(code);
+        rows.push_back(std::move(row));
+    }
+    return rows;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc != 5) {
+        std::cerr << "usage: pack_assets <pieces_dir> <pic_dir> <sounds_dir> <output.pack>" << std::endl;
+        return 2;
+    }
+    const fs::path pieces_root = argv[1], pic_dir = argv[2], sounds_dir = argv[3], output = argv[4];
+    try {
+        for (const char* name : {"board.csv", "board.png"}) {
+            if (!fs::exists(pieces_root / name)) throw std::runtime_error("File not found: " + (pieces_root / name).string());
+        }
+        AssetPackWriter writer;
+        writer.set_cell_px(CELL_PX);
+        writer.set_layout(read_layout(pieces_root / "board.csv"));
+        Img board_img = ImgFactory()(pieces_root / "board.png", {CELL_PX * 8, CELL_PX * 8}, false);
+        writer.set_board_image(board_img.img);
+
+        // Same loading path as create_game, so the pack holds exactly what it would build
+        Board board(CELL_PX, CELL_PX, 8, 8, board_img);
+        auto atlas = std::make_shared<SpriteAtlas>();
+        AssetLoadTimings timings;
+        {
+            WorkerPool pool;
+            atlas->load(pieces_root, {CELL_PX, CELL_PX}, nullptr, &pool, &timings);
+        }
+        std::cout << "[STARTUP] " << timings.to_string() << std::endl;
+        PieceFactory pf(board, pieces_root, nullptr, nullptr, atlas);
+        size_t types = 0;
+        for (const auto& dir : fs::directory_iterator(pieces_root)) {
+            if (!dir.is_directory() || !fs::exists(dir.path() / "states")) continue;
+            writer.add_template(*pf.get_template(dir.path().filename().string()));
+            ++types;
+        }
+
+        // Pictures are stored decoded (as cv::imread returns them); sounds as the original WAV bytes
+        size_t pics = 0, sounds = 0;
+        for (const auto& file : files_with_extension(pic_dir, ".png")) {
+            cv::Mat img = cv::imread(file.string());
+            if (img.empty()) throw std::runtime_error("Cannot decode picture: " + file.string());
+            writer.add_image("pic/" + file.filename().string(), img);
+            ++pics;
+        }
+        for (const auto& file : files_with_extension(sounds_dir, ".wav")) {
+            std::ifstream f(file, std::ios::binary);
+            writer.add_blob("sounds/" + file.filename().string(),
+                            std::string(std::istreambuf_iterator<char>(f), std::istreambuf_iterator<char>()));
+            ++sounds;
+        }
+
+        writer.write(output);
+        std::cout << "Wrote " << output.string() << " (" << fs::file_size(output) / 1024 << " KiB): " << types
+                  << " piece types, " << timings.files << " sprite frames, " << pics << " pictures, " << sounds
+                  << " sounds" << std::endl;
+    } catch (const std::exception& ex) {
+        std::cerr << "[ERROR] pack_assets: " << ex.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}